@@ -0,0 +1,42 @@
+function [VOXELS, SIZES, BBOXES, HOLES, L] = ml_3dconncomp(BINIMG,FINDHOLES)
+% [VOXELS, SIZES, BBOXES, HOLES, L] = ML_3DCONNCOMP(BINIMG,FINDHOLES) 26-connected objects of a 3D image
+% ML_3DCONNCOMP(BINIMG,FINDHOLES),
+%     Labels the 26-connected components of the nonzero voxels of
+%     BINIMG (logical, uint8, uint16 or double) with union-find.  For
+%     the N objects, numbered as by BWCONNCOMP:
+%        VOXELS - N x 1 cell array of 3 x SIZES(k) uint16 [row;col;slice]
+%                 coordinates
+%        SIZES  - number of voxels of each object
+%        BBOXES - N x 6 [rowmin colmin slicemin rowmax colmax slicemax]
+%        HOLES  - number of holes of each object if FINDHOLES is nonzero,
+%                 NaN otherwise
+%        L      - the uint32 label volume
+%
+%     Holes are the 26-connected background components that do not
+%     touch the border of the image.  The background is labeled once and
+%     each hole is counted for the object that encloses it (its adjacent
+%     object nearest to the outside), so a hole may contain other
+%     objects.
+%
+%     See also ML_3DFINDOBJ, BWCONNCOMP
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,39 @@
+function [EDGEPIX, EDGEFLUOR, PIXELS, FLUOR, EDGES] = ml_3dedgesums(I,MASK)
+% [EDGEPIX, EDGEFLUOR, PIXELS, FLUOR, EDGES] = ML_3DEDGESUMS(I,MASK) edge sums of a 3D image
+% ML_3DEDGESUMS(I,MASK),
+%     Detects the edges of every slice of the binary volume MASK as
+%     EDGE(MASK(:,:,z)) does with its default (Sobel) settings and
+%     returns, in a single pass over the volume:
+%        EDGEPIX   - the number of edge pixels
+%        EDGEFLUOR - the sum of I over the edge pixels
+%        PIXELS    - the number of nonzero voxels of MASK
+%        FLUOR     - the sum of I over the nonzero voxels of MASK
+%     EDGES (optional) is the logical edge volume; when it is not
+%     requested only one slice of working memory per thread is used.
+%
+%     I may be uint8, uint16, int32, single or double and MASK
+%     logical, uint8, uint16 or double.  Slices are processed in
+%     parallel when the MEX file is compiled with OpenMP.
+%
+%     See also ML_3DEDGEFEATURES, EDGE
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,40 @@
+function [WMEAN, D] = ml_3dedt(BW,W,SPACING)
+% [WMEAN, D] = ML_3DEDT(BW,W,SPACING) weighted mean of the Euclidean distance transform
+% ML_3DEDT(BW,W,SPACING),
+%     Computes the exact Euclidean distance of every voxel of the 2D or
+%     3D image BW to the nearest nonzero voxel of BW and returns WMEAN,
+%     the mean of W.*D over the whole image.  W is a weight image of
+%     the same size as BW (uint8, uint16, single or double), or [] for
+%     weights of 1.  SPACING is the voxel size [row col slice] (default
+%     [1 1 1]).
+%
+%     The distance volume D is only built when it is requested; for
+%     unit spacing it equals BWDIST(BW) (single precision, Inf
+%     everywhere if BW has no nonzero voxel).
+%
+%     The transform is separable and linear in the number of voxels
+%     (Felzenszwalb and Huttenlocher); lines are processed in parallel
+%     when the MEX file is compiled with OpenMP.
+%
+%     See also ML_3DDTFEATURES, BWDIST
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,41 @@
+function [M, MU, COUNT] = ml_3dobjmoments(I,L)
+% [M, MU, COUNT] = ML_3DOBJMOMENTS(I,L) moments of every object in a 3D label volume
+% ML_3DOBJMOMENTS(I,L),
+%     Returns the raw moments M and the central moments MU up to order 4
+%     of each object of the label volume L, one row per label
+%     (N = max(L(:))), and the number of voxels COUNT of each label.
+%     The 35 columns hold m_pqr ordered by degree d = p+q+r = 0..4 and,
+%     within a degree, for p=d:-1:0, for q=d-p:-1:0, r=d-p-q:
+%        [m000 m100 m010 m001 m200 m110 m101 m020 m011 m002 m300 ...]
+%     x is the column, y the row and z the slice (1-based).  Central
+%     moments are taken about the center of fluorescence; objects with
+%     m000 == 0 get NaN central moments.
+%
+%     If L is omitted or empty the whole volume is a single object.
+%
+%     I may be uint8, uint16, int32, single, double or logical.  L may
+%     be double, int32, uint32, uint16, uint8 or logical; label 0 is
+%     background.  The volume is scanned once.
+%
+%     See also ML_OBJMOMENTS, ML_3DFINDOBJ
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,46 @@
+function [STATS, COFS] = ml_3dobjstats(L,PROTIMG,DNA,SCALE,SCALEDIST)
+% [STATS, COFS] = ML_3DOBJSTATS(L,PROTIMG,DNA,SCALE,SCALEDIST) 3D descriptors of every object
+% ML_3DOBJSTATS(L,PROTIMG,DNA,SCALE,SCALEDIST),
+%     Computes the per-object descriptors used by ML_OBJ2FEAT for every
+%     label of the 3D label volume L, one row of STATS per label:
+%        1      number of voxels
+%        2      protein fluorescence (sum of PROTIMG)
+%        3-5    center of fluorescence (COF) [row col slice]
+%        6, 7   distances to the protein and DNA COFs (SCALEDIST)
+%        8, 9   horizontal and vertical distances to the protein COF
+%        10, 11 horizontal and vertical distances to the DNA COF
+%        12-14  eigenvalues of the covariance (inertia) of the voxel
+%               coordinates in SCALE units, largest first
+%        15     eccentricity sqrt(1 - STATS(:,14)./STATS(:,12))
+%     COFS is [protein COF, DNA COF]; the protein COF is taken over the
+%     labeled voxels, as by ML_FINDCOFS.
+%
+%     DNA is the DNA image, its COF [row;col;slice] or [] (DNA columns
+%     are then NaN).  SCALE is the voxel size for the horizontal and
+%     vertical distances and the inertia (default [1 1 1]) and
+%     SCALEDIST the voxel size for the 3D distances (default SCALE).
+%     Objects are processed in parallel when the MEX file is compiled
+%     with OpenMP.
+%
+%     See also ML_OBJ2FEAT, ML_FINDCOFS, ML_3DFINDOBJ
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
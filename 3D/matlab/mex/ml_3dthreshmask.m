@@ -0,0 +1,42 @@
+function [BINIMAGE, PROCIMAGE, THRESH, MOSTCOMMON] = ml_3dthreshmask(IMAGE,METHOD,BGSUB,CROPIMAGE)
+% [BINIMAGE, PROCIMAGE, THRESH, MOSTCOMMON] = ML_3DTHRESHMASK(IMAGE,METHOD,BGSUB,CROPIMAGE) background subtraction and thresholding
+% ML_3DTHRESHMASK(IMAGE,METHOD,BGSUB,CROPIMAGE),
+%     Does the background subtraction, cropping, thresholding and
+%     binarization steps of ML_3DPREPROCESS in two passes over IMAGE:
+%        MOSTCOMMON - the most common value of IMAGE, subtracted with
+%                     saturation at 0 when BGSUB is true (default)
+%        PROCIMAGE  - the subtracted image, set to 0 where CROPIMAGE is 0
+%        THRESH     - 255*ML_THRESHOLD(PROCIMAGE) for METHOD 'nih'
+%                     (default) or ML_RCTHRESHOLD(PROCIMAGE) for 'rc'
+%        BINIMAGE   - the uint8 image PROCIMAGE >= floor(THRESH), as
+%                     ML_BINARIZE returns it
+%     The threshold is found from the histogram of IMAGE, so PROCIMAGE
+%     is only built when it is requested.
+%
+%     IMAGE may be uint8 or uint16 ('rc' only).  CROPIMAGE is [] or a
+%     logical or uint8 mask the size of IMAGE or of one of its slices.
+%     Both passes run in parallel when the MEX file is compiled with
+%     OpenMP.
+%
+%     See also ML_3DPREPROCESS, ML_3DBGSUB, ML_BINARIZE, ML_RCTHRESHOLD
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,44 @@
+function [F, OMEGA] = ml_3dzernike(LABELED, IMAGE, N, R, SPACING)
+% [F, OMEGA] = ML_3DZERNIKE(LABELED, IMAGE, N, R, SPACING) 3D Zernike descriptors
+% ML_3DZERNIKE(LABELED, IMAGE, N, R, SPACING),
+%     Returns the rotation invariant 3D Zernike descriptors F of every
+%     object in the label volume LABELED (label 0 is background), one
+%     row per label.  F(K,:) holds F_nl = norm(OMEGA_nl^m, m=-l:l) for
+%     n=0:N, l=0:n, mod(n-l,2)==0.  OMEGA holds the complex moments
+%     OMEGA_nl^m for m=0:l in the same order.
+%
+%     IMAGE is a weight volume of the same size as LABELED, or [] to
+%     use the shape of the objects only.  R is the radius of the unit
+%     ball; 0 or [] fits the ball to each object.  SPACING is the voxel
+%     size [ROW COL SLICE] (default [1 1 1]).
+%
+%     The moments are obtained from per-object geometric moments and a
+%     precomputed table of polynomial coefficients; objects are processed
+%     in parallel when the MEX file is compiled with OpenMP.
+%
+%     Reference: M. Novotni and R. Klein (2003). 3D Zernike Descriptors
+%       for Content Based Shape Retrieval.  Proc. ACM Symposium on
+%       Solid Modeling and Applications.
+%
+%     See also ML_3DZERNIKEFEATS, ML_3DFINDOBJ
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,30 @@
+function COUNT = ml_maskcount(PACKED)
+% COUNT = ML_MASKCOUNT(PACKED) number of true voxels of a bit-packed mask
+% ML_MASKCOUNT(PACKED),
+%     Counts the bits set in PACKED, a mask returned by
+%     ML_BINARIZE(IMAGE,THRESH,'packed'), with a population count per
+%     64-bit word.  COUNT equals NNZ(ML_UNPACKMASK(PACKED,SIZE(IMAGE)))
+%     without building the unpacked mask.
+%
+%     See also ML_BINARIZE, ML_UNPACKMASK
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
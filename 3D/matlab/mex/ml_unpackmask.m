@@ -0,0 +1,31 @@
+function [MASK, COUNT] = ml_unpackmask(PACKED,DIMS)
+% [MASK, COUNT] = ML_UNPACKMASK(PACKED,DIMS) unpacks a bit-packed mask
+% ML_UNPACKMASK(PACKED,DIMS),
+%     Expands PACKED, a mask returned by ML_BINARIZE(IMAGE,THRESH,'packed'),
+%     to the logical array MASK of size DIMS, normally SIZE(IMAGE).
+%     Voxel k of MASK is bit MOD(k-1,64) of PACKED(CEIL(k/64)), least
+%     significant bit first.  COUNT (optional) is NNZ(MASK), computed
+%     from the packed words.
+%
+%     See also ML_BINARIZE, ML_MASKCOUNT
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -1,11 +1,12 @@
-function outimg = ml_3dbgsub(image)
+function [outimg, MostCommonPixelValue] = ml_3dbgsub(image)
 % ml_3dbgsub substracts the most common pixel value of the image. 
 
 % This method is an adaptation of ml_3dbgsub.c.
 
-% Input: image, must be a 3D array
+% Input: image, must be a 3D array of class uint8 or uint16
 
 % Output: outimg, the output image, 3D array
+%         MostCommonPixelValue, the value that was subtracted
 
 
 % Author: Yue Yu (yuey1@andrew.cmu.edu)
@@ -59,8 +60,8 @@ NDims = size(size(image),2); % get the dimension of image
 if NDims ~= 3
     error('image must be a 3D array')
 end
-if ~strcmp(class(image),'uint8')
-    error('The argument to ml_3dbgsub() should be a 3D matrix of type uint8')
+if ~isa(image,'uint8') && ~isa(image,'uint16')
+    error('The argument to ml_3dbgsub() should be a 3D matrix of type uint8 or uint16')
 end
 
 [Height,Width,Depth] = size(image);
@@ -7,6 +7,7 @@ function [pencpixel, penflu] = ml_3dedgefeatures(protimg, protbin)
 %   PENCPIXEL is the ratio of number of white pixels on the edge to 
 %   the number on white pixels in MASK. PENFLU is the fraction of 
 %   fluorescence on the edge in masked positions.
+%   The edges and sums are computed by the MEX function ML_3DEDGESUMS.
 
 % Copyright (C) 2006  Murphy Lab
 % Carnegie Mellon University
@@ -29,19 +30,7 @@ function [pencpixel, penflu] = ml_3dedgefeatures(protimg, protbin)
 % For additional information visit http://murphylab.web.cmu.edu or
 % send email to murphy@cmu.edu
 
-pixelt = sum(protbin(:));
-protclean = ml_mask(protimg, protbin);
-fluort = sum(protclean(:));
-
-pixele = 0;
-fluore = 0;
-
-for m = 1 : size(protimg, 3)
-    bw = edge(protbin(:, :, m));
-    pixele = pixele + sum(bw(:));
-    tmp = ml_mask(protimg(:, :, m), bw);
-    fluore = fluore + sum(tmp(:));
-end
+[pixele, fluore, pixelt, fluort] = ml_3dedgesums(protimg, protbin);
 
 pencpixel = pixele / pixelt * 100;
 penflu = fluore / fluort * 100;
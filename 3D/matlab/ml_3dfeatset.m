@@ -21,6 +21,7 @@ function [names, features, slfnames] = ml_3dfeatset( image, featsetname, ...
 %             'SLF18'         - SLF18 34 first 34 SDA selected features from SLF11 (specific for 3D 3T3 Set)	       
 %             'SLF19'         - SLF19 56 SLF11 & the 14 DNA features from SLF9
 %             'SLF20'         - SLF20 52 SDA selected features from SLF19 
+%             'TAS3D'         - 54 threshold adjacency statistics over the 26-neighborhood (see ML_TAS)
 %
 %	CROPIMAGE = binary 2D/3D mask (optional), which defines the region of single cell
 %		    if not defined supply empty matrix []
@@ -132,6 +133,8 @@ case 'SLF38'
     % force the definition of gray levels and subtractions method for this feature set
     tgray = 256;
     bgsub = 'nobgsub';
+case 'TAS3D'
+    featidx = [];
 otherwise
     error( 'Unrecognized feature set name');
 end
@@ -219,7 +222,11 @@ end
 
 % Calculate features
 
-[n,f,s] = ml_3dfeat(image,dnaimage,featidx,tratio,tgray,scale,threshmeth);
+if strcmp(featsetname,'TAS3D')
+    [n,f,s] = ml_tas(image);
+else
+    [n,f,s] = ml_3dfeat(image,dnaimage,featidx,tratio,tgray,scale,threshmeth);
+end
 
 % Output features
 
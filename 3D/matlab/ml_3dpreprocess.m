@@ -105,6 +105,22 @@ switch contstr
         error('Unknown contrast stretching method');
 end
 
+% Background subtraction, cropping, thresholding and binarization in
+% two passes over the voxels, without intermediate volumes
+if isa(image,'uint8') || (isa(image,'uint16') && strcmp(threshmeth,'rc'))
+    if ~exist('cropimage','var') || isempty(cropimage)
+        cropimage = [];
+    elseif ~islogical(cropimage) && ~isa(cropimage,'uint8')
+        cropimage = cropimage ~= 0;
+    end
+    if size(cropimage,3) > 1 && size(cropimage,3) ~= size(image,3)
+        error('MASKING must be either 2D or have same number of slices as IMG.');
+    end
+    [binimage,image] = ml_3dthreshmask( image, threshmeth, ...
+        ~strcmp( bgsub,'nobgsub'), cropimage);
+    return
+end
+
 if ~strcmp( bgsub,'nobgsub')
     image = ml_3dbgsub( image);
 end
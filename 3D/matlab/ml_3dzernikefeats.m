@@ -0,0 +1,80 @@
+function [names, features] = ml_3dzernikefeats( objects, imgsize, protimg, order, radius, scale)
+
+% [NAMES, FEATURES] = ML_3DZERNIKEFEATS( OBJECTS, IMGSIZE, PROTIMG, ORDER, RADIUS, SCALE)
+%
+% Calculates the rotation invariant 3D Zernike descriptors of every
+% object in a list of objects like the one returned by ml_3dfindobj.
+% OBJECTS is the list of objects, IMGSIZE the size of the image they
+% were found in.
+% PROTIMG (optional) is the image the objects were found in; the
+% descriptors are then weighted by fluorescence. If empty or omitted,
+% only the shape of the objects is used.
+% ORDER (optional) is the maximum order of the moments (default 10).
+% RADIUS (optional) is the radius of the unit ball, in the units of
+% SCALE. If empty or 0 (default) the ball is fitted to each object.
+% SCALE (optional) is the voxel size [row col slice] (default [1 1 1]).
+%
+% FEATURES is a length(OBJECTS) x N matrix, one row per object, and
+% NAMES the corresponding descriptor names 'Z3D_n,l'.
+%
+% The objects are written into one label volume and the moments of
+% all objects are computed in a single call to ml_3dzernike.
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
+
+if ~exist('protimg','var')
+    protimg = [];
+end
+
+if ~exist('order','var') | isempty(order)
+    order = 10;
+end
+
+if ~exist('radius','var') | isempty(radius)
+    radius = 0;
+end
+
+if ~exist('scale','var') | isempty(scale)
+    scale = [1 1 1];
+end
+
+nobjects = length(objects);
+if nobjects < 65536
+    labeled = zeros(imgsize,'uint16');
+else
+    labeled = zeros(imgsize,'uint32');
+end
+
+for m = 1 : nobjects
+    voxels = double(objects{m}.voxels);
+    idx = sub2ind(imgsize, voxels(1,:), voxels(2,:), voxels(3,:));
+    labeled(idx) = m;
+end
+
+features = ml_3dzernike(labeled, protimg, order, radius, double(scale));
+
+names = {};
+for n = 0 : order
+    for l = mod(n,2) : 2 : n
+        names = [names cellstr(sprintf('Z3D_%i,%i', n, l))];
+    end
+end
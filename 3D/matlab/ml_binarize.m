@@ -1,4 +1,4 @@
-function outimg = ml_binarize(image,thresh)
+function outimg = ml_binarize(image,thresh,mode)
 % ml_binarize calculates the the binary image given a image and a threshold 
 
 % This method is an adaptation of ml_binarize.c.
@@ -7,6 +7,9 @@ function outimg = ml_binarize(image,thresh)
 
 %        thresh, the threshold used for binarize the image
 
+%        mode, optional, 'packed' returns the binary image with one bit
+%        per voxel in a uint64 column vector (see ml_unpackmask)
+
 % Output: outimg,the binary image
 
 
@@ -58,6 +61,21 @@ function outimg = ml_binarize(image,thresh)
 if ~isa(thresh,'uint8')
     error('THRESH argument must be of class uint8')
 end
+if exist('mode','var')
+    if ~strcmp(mode,'packed')
+        error('The third argument to ml_binarize() must be ''packed''')
+    end
+    % voxel k is bit mod(k-1,64) of word ceil(k/64)
+    bits = image(:) >= thresh;
+    bits(end+1:64*ceil(numel(bits)/64)) = false;
+    bits = reshape(bits,64,[]);
+    outimg = zeros(size(bits,2),1,'uint64');
+    for k = 1:64
+        outimg(bits(k,:)) = bitor(outimg(bits(k,:)),bitshift(uint64(1),k-1));
+    end
+    return
+end
+
 outimg = image;
 oneindex = outimg >= thresh;
 zeroindex = outimg < thresh;
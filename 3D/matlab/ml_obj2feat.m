@@ -88,18 +88,29 @@ else
 end
 
 % find COF stuff
-[ProtCOF, ProtCOFs] = ml_findCOFs( protobj, protimg);
-ProtCOFDists = ml_eucdist( ProtCOF, ProtCOFs, scaledist); % this and subsequent 'scaledist' added, jnewberg 11/24/05
+% The per-object sizes, COFs and distances are computed by ml_3dobjstats
+% from a label volume of the objects, in parallel over the objects
+imgsize = size(protimg);
+if NObj < 65536
+    labeled = zeros(imgsize,'uint16');
+else
+    labeled = zeros(imgsize,'uint32');
+end
+for o = 1 : NObj
+    v = double(protobj{o}.voxels);
+    labeled(sub2ind(imgsize, v(1,:), v(2,:), v(3,:))) = o;
+end
+[objstats, COFs] = ml_3dobjstats(labeled, protimg, DNACOF, scale, scaledist);
+ProtCOF = COFs(:,1);
 
 % COF features relating object distances to Protein COF
-[features(6),features(7),features(8)] = ml_ObjCOFfeats( ProtCOFDists);
+[features(6),features(7),features(8)] = ml_ObjCOFfeats( objstats(:,6)');
 
 
 % COF features relating Protein to DNA
 if (~isempty(DNACOF))
     % Average dist, stddev dist and max/min dist.
-    ProtDNADists = ml_eucdist( DNACOF, ProtCOFs, scaledist);
-    [features(9),features(10),features(11)] = ml_ObjCOFfeats( ProtDNADists);
+    [features(9),features(10),features(11)] = ml_ObjCOFfeats( objstats(:,7)');
     % Distance between Prot COF and DNA COF
     features(12) = ml_eucdist( ProtCOF, DNACOF, scaledist);
     % Ratio of protein volume to DNA volume
@@ -115,22 +126,16 @@ end
 
 %%%%%%%%%%%% 3D vertical-horizontal sensitive features%%%%%%%%%%%%%%%%%%
 % Get the horizontal and vertical components of distances of
-% objects from COF of protein and DNA
-ProtCOFDistsH = ml_eucdist( ProtCOF(1:2,:), ProtCOFs(1:2,:),scale(:,1:2));
-ProtCOFDistsV = ml_eucdist( ProtCOF(3,:), ProtCOFs(3,:),scale(3));
-if (~isempty(DNACOF))
-    ProtDNADistsH = ml_eucdist( DNACOF(1:2,:), ProtCOFs(1:2,:),scale(:,1:2));
-    ProtDNADistsV = ml_eucdist( DNACOF(3,:), ProtCOFs(3,:),scale(3));
-end
+% objects from COF of protein and DNA (columns 8-11 of objstats)
 % COF features relating object distances to Protein COF
-[features(15),features(16),features(17)] = ml_ObjCOFfeats( ProtCOFDistsH);
-[features(18),features(19),features(20)] = ml_ObjCOFfeats( ProtCOFDistsV);
+[features(15),features(16),features(17)] = ml_ObjCOFfeats( objstats(:,8)');
+[features(18),features(19),features(20)] = ml_ObjCOFfeats( objstats(:,9)');
 
 if (~isempty(DNACOF))
     % COF features relating Protein to DNA
     % Average dist, stddev dist and max/min dist.
-    [features(21),features(22),features(23)] = ml_ObjCOFfeats( ProtDNADistsH);
-    [features(24),features(25),features(26)] = ml_ObjCOFfeats( ProtDNADistsV);
+    [features(21),features(22),features(23)] = ml_ObjCOFfeats( objstats(:,10)');
+    [features(24),features(25),features(26)] = ml_ObjCOFfeats( objstats(:,11)');
     % Distance between Prot COF and DNA COF
     features(27) = ml_eucdist( ProtCOF(1:2,:), DNACOF(1:2,:),scale(:,1:2)); % horizontal
     features(28) = (ProtCOF(3,:) - DNACOF(3,:))*scale(3); % vertical
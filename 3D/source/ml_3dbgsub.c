@@ -33,19 +33,24 @@
 #include <sys/resource.h>
 #include <unistd.h>
 #include <sys/types.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-unsigned char find_most_common( unsigned char *Image, unsigned long length)
+/*/ Images are histogrammed and subtracted in blocks of this many voxels */
+#define BGSUB_BLOCK 65536
+
+/*/ Index of the first largest bin of a histogram */
+static unsigned long histogram_mode( const unsigned long *hist, unsigned long nbins)
 {
-  unsigned long hist[256];
-  unsigned long highest_count;
-  unsigned char most_common_idx;
+  unsigned long highest_count = hist[0];
+  unsigned long most_common_idx = 0;
   unsigned long i;
-  
-  for( i = 0; i < 256; i++) hist[i] = 0;
-  for( i = 0; i < length; i++) hist[Image[i]]++;
-  highest_count = hist[0];
-  most_common_idx = 0;
-  for( i = 1; i < 256; i++) {
+
+  for( i = 1; i < nbins; i++) {
     if( hist[i] > highest_count) {
       highest_count = hist[i];
       most_common_idx = i;
@@ -54,36 +59,159 @@ unsigned char find_most_common( unsigned char *Image, unsigned long length)
   return most_common_idx;
 }
 
+/*/ Histograms of uint8 (IMAGE8) or uint16 (IMAGE16) voxels.  Each thread
+ *  fills its own histogram, the histograms are added at the end.  The
+ *  nthreads*nbins counters are allocated here, outside the parallel region. */
+static void image_histogram( const unsigned char *Image8,
+			     const unsigned short *Image16,
+			     unsigned long length, unsigned long nbins,
+			     unsigned long *hist)
+{
+  unsigned long *partial;
+  unsigned long i;
+  int nthreads = 1, t;
+
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+  if( length < BGSUB_BLOCK) nthreads = 1;
+#endif
+  partial = (unsigned long*) calloc( (size_t) nthreads * nbins, sizeof(unsigned long));
+  if( partial == NULL) {
+    nthreads = 0;
+    partial = hist;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads > 0 ? nthreads : 1)
+#endif
+  {
+    unsigned long *h = partial;
+    long k;
+
+#ifdef _OPENMP
+    if( nthreads > 0) h += nbins * omp_get_thread_num();
+#pragma omp for schedule(static)
+#endif
+    for( k = 0; k < (long) length; k++) {
+      if( Image8) h[Image8[k]]++;
+      else h[Image16[k]]++;
+    }
+  }
+
+  if( nthreads == 0) return;
+  for( i = 0; i < nbins; i++) hist[i] = 0;
+  for( t = 0; t < nthreads; t++)
+    for( i = 0; i < nbins; i++) hist[i] += partial[t * nbins + i];
+  free( partial);
+}
+
+unsigned char find_most_common( unsigned char *Image, unsigned long length)
+{
+  unsigned long hist[256];
+
+  memset( hist, 0, sizeof(hist));
+  image_histogram( Image, NULL, length, 256, hist);
+  return (unsigned char) histogram_mode( hist, 256);
+}
+
+unsigned short find_most_common16( unsigned short *Image, unsigned long length)
+{
+  unsigned long *hist = (unsigned long*) calloc( 65536, sizeof(unsigned long));
+  unsigned short most_common;
+
+  if( hist == NULL) {
+#ifdef _MEX_
+    mexErrMsgTxt("ml_3dbgsub(): out of memory for the uint16 histogram.");
+#else
+    fputs( "ml_3dbgsub(): out of memory for the uint16 histogram.\n", stderr);
+    exit( EXIT_FAILURE);
+#endif
+  }
+  image_histogram( NULL, Image, length, 65536, hist);
+  most_common = (unsigned short) histogram_mode( hist, 65536);
+  free( hist);
+  return most_common;
+}
+
+/*/ output[i] = max(Image[i] - value, 0).  Output may be Image itself, so
+ *  the subtraction can be done in place.  Blocks are subtracted in
+ *  parallel, 16 bytes at a time with SSE2 (psubusb / psubusw). */
+void subtract_saturate( unsigned char *Image, unsigned char *output,
+			unsigned long length, unsigned char value)
+{
+  long nblocks = (long) ((length + BGSUB_BLOCK - 1) / BGSUB_BLOCK);
+  long b;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(nblocks > 1)
+#endif
+  for( b = 0; b < nblocks; b++) {
+    unsigned long i = (unsigned long) b * BGSUB_BLOCK;
+    unsigned long end = i + BGSUB_BLOCK < length ? i + BGSUB_BLOCK : length;
+#ifdef __SSE2__
+    __m128i v = _mm_set1_epi8( (char) value);
+
+    for( ; i + 16 <= end; i += 16) {
+      __m128i x = _mm_loadu_si128( (const __m128i*) (Image + i));
+      _mm_storeu_si128( (__m128i*) (output + i), _mm_subs_epu8( x, v));
+    }
+#endif
+    for( ; i < end; i++)
+      output[i] = Image[i] > value ? Image[i] - value : 0;
+  }
+}
+
+void subtract_saturate16( unsigned short *Image, unsigned short *output,
+			  unsigned long length, unsigned short value)
+{
+  long nblocks = (long) ((length + BGSUB_BLOCK - 1) / BGSUB_BLOCK);
+  long b;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(nblocks > 1)
+#endif
+  for( b = 0; b < nblocks; b++) {
+    unsigned long i = (unsigned long) b * BGSUB_BLOCK;
+    unsigned long end = i + BGSUB_BLOCK < length ? i + BGSUB_BLOCK : length;
+#ifdef __SSE2__
+    __m128i v = _mm_set1_epi16( (short) value);
+
+    for( ; i + 8 <= end; i += 8) {
+      __m128i x = _mm_loadu_si128( (const __m128i*) (Image + i));
+      _mm_storeu_si128( (__m128i*) (output + i), _mm_subs_epu16( x, v));
+    }
+#endif
+    for( ; i < end; i++)
+      output[i] = Image[i] > value ? Image[i] - value : 0;
+  }
+}
+
 #ifdef _MEX_
+/*/ [OUTIMG, MOSTCOMMON] = ml_3dbgsub(IMG) subtracts the most common voxel
+ *  value MOSTCOMMON of the uint8 or uint16 3D image IMG, clamping at 0 */
 void mexFunction(
 		 int nlhs,
 		 mxArray *plhs[], 
 		 int nrhs,
 		 const mxArray *prhs[])
 {
-  unsigned char* output ;     /*/ Return value to Matlab */
-
-    int x, y, z, i;
-    long n_voxels; /*/ The total number of voxels in the image */
-
-    unsigned char *Image;
-    long NDims;
-    const int *Dims;
-    int Width, Height, Depth;
-
-    unsigned char MostCommonPixelValue;
-    int newvalue;
+    unsigned long n_voxels; /*/ The total number of voxels in the image */
+    mwSize NDims;
+    const mwSize *Dims;
+    mxClassID ClassID;
+    double MostCommonPixelValue;
 
     /*/ Argument checking */
     if (nrhs != 1) {
       mexErrMsgTxt("ml_3dbgsub() requires one input argument.") ;
-    } else if (nlhs != 1) {
-      mexErrMsgTxt("ml_3dbgsub() returns a single output.") ;
+    } else if (nlhs > 2) {
+      mexErrMsgTxt("ml_3dbgsub() returns at most two outputs.") ;
     }
 
-    if (!mxIsUint8(prhs[0])) {
+    ClassID = mxGetClassID( prhs[0]);
+    if (ClassID != mxUINT8_CLASS && ClassID != mxUINT16_CLASS) {
       mexErrMsgTxt("The argument to ml_3dbgsub() should be a 3D matrix\n."
-			"of type uint8") ;
+			"of type uint8 or uint16") ;
     }
 
     /*/ Get Image size info etc */
@@ -92,28 +220,31 @@ void mexFunction(
       mexErrMsgTxt("Input image must be 3-dimensional");
     }
     Dims = mxGetDimensions( prhs[0]);
-    Height = Dims[0];
-    Width = Dims[1];
-    Depth = Dims[2];
-    n_voxels = Width * Height * Depth; 
-
-    /* Get hold of the input image */
-    Image = (unsigned char*) mxGetData( prhs[0]);
+    n_voxels = mxGetNumberOfElements( prhs[0]);
 
     /*// Create output image*/
-    plhs[0] = mxCreateNumericArray(NDims, Dims, mxUINT8_CLASS, mxREAL) ;
-    output = (unsigned char*) mxGetData(plhs[0]) ;
+    plhs[0] = mxCreateNumericArray(NDims, Dims, ClassID, mxREAL) ;
 
     /*////////////////////////////////////////////////////////////////*/
-    MostCommonPixelValue = find_most_common( Image, n_voxels);
-    /*/printf("Most common value is %i",MostCommonPixelValue);*/
-    for( i = 0; i < n_voxels; i++) {
-      newvalue = Image[i] - MostCommonPixelValue;
-      if( newvalue < 0) newvalue = 0;
-      output[i] = newvalue;
+    if( ClassID == mxUINT8_CLASS) {
+      unsigned char *Image = (unsigned char*) mxGetData( prhs[0]);
+      unsigned char MostCommon = find_most_common( Image, n_voxels);
+
+      subtract_saturate( Image, (unsigned char*) mxGetData(plhs[0]),
+			 n_voxels, MostCommon);
+      MostCommonPixelValue = MostCommon;
+    } else {
+      unsigned short *Image = (unsigned short*) mxGetData( prhs[0]);
+      unsigned short MostCommon = find_most_common16( Image, n_voxels);
+
+      subtract_saturate16( Image, (unsigned short*) mxGetData(plhs[0]),
+			   n_voxels, MostCommon);
+      MostCommonPixelValue = MostCommon;
     }
     /*////////////////////////////////////////////////////////////////*/
 
+    if( nlhs > 1) plhs[1] = mxCreateDoubleScalar( MostCommonPixelValue);
+
     return ;
 }
 
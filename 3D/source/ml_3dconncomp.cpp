@@ -0,0 +1,473 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_3dconncomp.cpp
+//
+//  26-connected components of a 3D binary image with their voxel lists,
+//  sizes, bounding boxes and number of holes.
+//
+//  [VOXELS, SIZES, BBOXES, HOLES, L] = ml_3dconncomp(BINIMG, FINDHOLES)
+//  where:
+//     -BINIMG is a 2D or 3D image (logical, uint8, uint16 or double);
+//      every nonzero voxel is foreground
+//     -FINDHOLES (optional, default 0) enables the hole count
+//     -VOXELS is an N x 1 cell array, VOXELS{k} the 3 x SIZES(k) uint16
+//      matrix of the [row; col; slice] coordinates of object k in
+//      increasing linear index order
+//     -SIZES is an N x 1 vector with the number of voxels of each object
+//     -BBOXES is an N x 6 matrix [rowmin colmin slicemin rowmax colmax
+//      slicemax]
+//     -HOLES is an N x 1 vector with the number of holes of each object,
+//      or NaN if FINDHOLES is 0
+//     -L (optional) is the uint32 label volume
+//  Objects are numbered in the order of their first voxel, as by
+//  bwconncomp and bwlabeln.
+//
+//  Both the objects and the background are labeled in one raster scan
+//  each with union-find over the 13 already visited neighbors.  A hole
+//  is a background component that does not touch the border of the
+//  image.  It belongs to the object that separates it from the outside:
+//  a breadth first search over the adjacency graph of background
+//  components and objects, started from the components on the border,
+//  gives every node its depth, and each hole is counted for its
+//  adjacent object of least depth.  As in the 26-connected bwlabeln of
+//  the inverted object used before, a hole may contain other objects;
+//  unlike it, pockets open to the border of the image are not holes.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* growing array of union-find parents */
+typedef struct UnionFind_tag
+{
+    uint32_T *parent;
+    uint32_T count;
+    uint32_T capacity;
+} UnionFind_T;
+
+static uint32_T uf_new(UnionFind_T *uf)
+{
+    if (uf->count == uf->capacity) {
+        uf->capacity = 2 * uf->capacity + 64;
+        uf->parent = (uint32_T *) mxRealloc(uf->parent,
+                                            uf->capacity * sizeof(uint32_T));
+    }
+    uf->parent[uf->count] = uf->count;
+    return uf->count++;
+}
+
+static uint32_T uf_find(UnionFind_T *uf, uint32_T a)
+{
+    uint32_T root = a, next;
+
+    while (uf->parent[root] != root)
+        root = uf->parent[root];
+    while (uf->parent[a] != root) {
+        next = uf->parent[a];
+        uf->parent[a] = root;
+        a = next;
+    }
+    return root;
+}
+
+/* links the larger root to the smaller, so roots are first labels */
+static uint32_T uf_union(UnionFind_T *uf, uint32_T a, uint32_T b)
+{
+    a = uf_find(uf, a);
+    b = uf_find(uf, b);
+    if (a < b) {
+        uf->parent[b] = a;
+        return a;
+    }
+    uf->parent[a] = b;
+    return b;
+}
+
+//
+// Labels the 26-connected components of the voxels with
+// (B != 0) == foreground into L (0 elsewhere), numbered from 1 in the
+// order of their first voxel.  Returns the number of components.
+//
+template<typename B_T>
+static uint32_T label_components(const B_T *B, const mwSize *dims,
+                                 bool foreground, uint32_T *L)
+{
+    mwSize rows = dims[0], cols = dims[1], slices = dims[2];
+    mwSize plane = rows * cols, r, c, z, p = 0;
+    UnionFind_T uf;
+    uint32_T *final_label, n = 0, k;
+
+    uf.capacity = 0;
+    uf.count = 0;
+    uf.parent = NULL;
+    uf_new(&uf);        /* label 0 is not a component */
+
+    for (z = 0; z < slices; z++) {
+        for (c = 0; c < cols; c++) {
+            for (r = 0; r < rows; r++, p++) {
+                uint32_T label = 0;
+                int dz, dc, dr;
+
+                if ((B[p] != 0) != foreground) {
+                    L[p] = 0;
+                    continue;
+                }
+
+                /* the 13 neighbors visited before p */
+                for (dz = -1; dz <= 0; dz++) {
+                    if (dz < 0 && z == 0)
+                        continue;
+                    for (dc = -1; dc <= 1; dc++) {
+                        if (dz == 0 && dc > 0)
+                            break;
+                        if ((dc < 0 && c == 0) || (dc > 0 && c + 1 == cols))
+                            continue;
+                        for (dr = -1; dr <= 1; dr++) {
+                            if (dz == 0 && dc == 0 && dr >= 0)
+                                break;
+                            if ((dr < 0 && r == 0) || (dr > 0 && r + 1 == rows))
+                                continue;
+                            uint32_T q = L[p + dz * (long) plane + dc * (long) rows + dr];
+                            if (q == 0)
+                                continue;
+                            label = (label == 0) ? uf_find(&uf, q) : uf_union(&uf, label, q);
+                        }
+                    }
+                }
+                L[p] = (label == 0) ? uf_new(&uf) : label;
+            }
+        }
+    }
+
+    /* roots are the smallest label of their set, so this numbers the */
+    /* components in the order of their first voxel */
+    final_label = (uint32_T *) mxMalloc(uf.count * sizeof(uint32_T));
+    final_label[0] = 0;
+    for (k = 1; k < uf.count; k++) {
+        uint32_T root = uf_find(&uf, k);
+        final_label[k] = (root == k) ? ++n : final_label[root];
+    }
+    for (p = 0; p < plane * slices; p++)
+        L[p] = final_label[L[p]];
+
+    mxFree(final_label);
+    mxFree(uf.parent);
+    return n;
+}
+
+static int compare_pairs(const void *a, const void *b)
+{
+    const uint32_T *x = (const uint32_T *) a, *y = (const uint32_T *) b;
+
+    if (x[0] != y[0])
+        return (x[0] < y[0]) ? -1 : 1;
+    if (x[1] != y[1])
+        return (x[1] < y[1]) ? -1 : 1;
+    return 0;
+}
+
+//
+// Number of holes of each of the nobj objects of L given the labels BL
+// of the nbg background components
+//
+static void count_holes(const uint32_T *L, const uint32_T *BL, const mwSize *dims,
+                        uint32_T nobj, uint32_T nbg, double *holes)
+{
+    mwSize rows = dims[0], cols = dims[1], slices = dims[2];
+    mwSize plane = rows * cols, r, c, z, p = 0;
+    mwSize npairs = 0, capacity = 1024, i;
+    uint32_T *pairs = (uint32_T *) mxMalloc(2 * capacity * sizeof(uint32_T));
+    /* nodes 1..nbg are background components, nbg+1..nbg+nobj objects */
+    uint32_T nnodes = nbg + nobj + 1, k;
+    bool *border = (bool *) mxCalloc(nnodes, sizeof(bool));
+    long *depth = (long *) mxMalloc(nnodes * sizeof(long));
+    mwSize *start = (mwSize *) mxCalloc(nnodes + 1, sizeof(mwSize));
+    uint32_T *adjacent, *queue;
+    mwSize head = 0, tail = 0;
+
+    /* background/object pairs of 26-neighbors and the border nodes */
+    for (z = 0; z < slices; z++) {
+        for (c = 0; c < cols; c++) {
+            for (r = 0; r < rows; r++, p++) {
+                uint32_T node = L[p] ? nbg + L[p] : BL[p];
+                int dz, dc, dr;
+
+                if (z == 0 || z + 1 == slices || c == 0 || c + 1 == cols ||
+                    r == 0 || r + 1 == rows)
+                    border[node] = true;
+
+                for (dz = -1; dz <= 0; dz++) {
+                    if (dz < 0 && z == 0)
+                        continue;
+                    for (dc = -1; dc <= 1; dc++) {
+                        if (dz == 0 && dc > 0)
+                            break;
+                        if ((dc < 0 && c == 0) || (dc > 0 && c + 1 == cols))
+                            continue;
+                        for (dr = -1; dr <= 1; dr++) {
+                            if (dz == 0 && dc == 0 && dr >= 0)
+                                break;
+                            if ((dr < 0 && r == 0) || (dr > 0 && r + 1 == rows))
+                                continue;
+                            mwSize q = p + dz * (long) plane + dc * (long) rows + dr;
+                            uint32_T bg, obj;
+                            if ((L[p] == 0) == (L[q] == 0))
+                                continue;
+                            bg = L[p] ? BL[q] : BL[p];
+                            obj = nbg + (L[p] ? L[p] : L[q]);
+                            if (npairs > 0 && pairs[2 * npairs - 2] == bg &&
+                                pairs[2 * npairs - 1] == obj)
+                                continue;
+                            if (npairs == capacity) {
+                                capacity *= 2;
+                                pairs = (uint32_T *) mxRealloc(pairs,
+                                    2 * capacity * sizeof(uint32_T));
+                            }
+                            pairs[2 * npairs] = bg;
+                            pairs[2 * npairs + 1] = obj;
+                            npairs++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* unique pairs, stored in both directions as adjacency lists */
+    qsort(pairs, npairs, 2 * sizeof(uint32_T), compare_pairs);
+    for (i = 0, k = 0; i < npairs; i++) {
+        if (k > 0 && compare_pairs(pairs + 2 * i, pairs + 2 * (k - 1)) == 0)
+            continue;
+        pairs[2 * k] = pairs[2 * i];
+        pairs[2 * k + 1] = pairs[2 * i + 1];
+        k++;
+    }
+    npairs = k;
+    for (i = 0; i < npairs; i++) {
+        start[pairs[2 * i] + 1]++;
+        start[pairs[2 * i + 1] + 1]++;
+    }
+    for (k = 0; k < nnodes; k++)
+        start[k + 1] += start[k];
+    adjacent = (uint32_T *) mxMalloc((2 * npairs + 1) * sizeof(uint32_T));
+    mwSize *fill = (mwSize *) mxMalloc((nnodes + 1) * sizeof(mwSize));
+    memcpy(fill, start, (nnodes + 1) * sizeof(mwSize));
+    for (i = 0; i < npairs; i++) {
+        adjacent[fill[pairs[2 * i]]++] = pairs[2 * i + 1];
+        adjacent[fill[pairs[2 * i + 1]]++] = pairs[2 * i];
+    }
+
+    /* depths from the outside: background on the border at 0, objects */
+    /* on the border at 1 */
+    queue = (uint32_T *) mxMalloc(nnodes * sizeof(uint32_T));
+    for (k = 0; k < nnodes; k++)
+        depth[k] = -1;
+    for (k = 1; k <= nbg; k++) {
+        if (border[k]) {
+            depth[k] = 0;
+            queue[tail++] = k;
+        }
+    }
+    for (k = nbg + 1; k < nnodes; k++) {
+        if (border[k]) {
+            depth[k] = 1;
+            queue[tail++] = k;
+        }
+    }
+    while (head < tail) {
+        uint32_T node = queue[head++];
+        for (i = start[node]; i < start[node + 1]; i++) {
+            if (depth[adjacent[i]] < 0) {
+                depth[adjacent[i]] = depth[node] + 1;
+                queue[tail++] = adjacent[i];
+            }
+        }
+    }
+
+    for (k = 1; k <= nobj; k++)
+        holes[k - 1] = 0.0;
+    for (k = 1; k <= nbg; k++) {
+        uint32_T owner = 0;
+        if (border[k])
+            continue;
+        for (i = start[k]; i < start[k + 1]; i++) {
+            uint32_T obj = adjacent[i];
+            if (depth[obj] >= 0 &&
+                (owner == 0 || depth[obj] < depth[owner] ||
+                 (depth[obj] == depth[owner] && obj < owner)))
+                owner = obj;
+        }
+        if (owner != 0)
+            holes[owner - nbg - 1]++;
+    }
+
+    mxFree(pairs);
+    mxFree(border);
+    mxFree(depth);
+    mxFree(start);
+    mxFree(adjacent);
+    mxFree(fill);
+    mxFree(queue);
+}
+
+template<typename B_T>
+static void compute_conncomp(const B_T *B, const mwSize *dims, mwSize ndims,
+                             bool findholes, int nlhs, mxArray *plhs[])
+{
+    mwSize rows = dims[0], cols = dims[1], slices = dims[2];
+    mwSize N = rows * cols * slices, r, c, z, p;
+    mxArray *labels = mxCreateNumericArray(ndims, dims, mxUINT32_CLASS, mxREAL);
+    uint32_T *L = (uint32_T *) mxGetData(labels);
+    uint32_T nobj = label_components(B, dims, true, L), k;
+
+    plhs[0] = mxCreateCellMatrix(nobj, 1);
+    plhs[1] = mxCreateDoubleMatrix(nobj, 1, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(nobj, 6, mxREAL);
+    plhs[3] = mxCreateDoubleMatrix(nobj, 1, mxREAL);
+    double *sizes = mxGetPr(plhs[1]);
+    double *bbox = mxGetPr(plhs[2]);
+    double *holes = mxGetPr(plhs[3]);
+    mwSize *filled = (mwSize *) mxCalloc(nobj + 1, sizeof(mwSize));
+    uint16_T **voxels = (uint16_T **) mxMalloc((nobj + 1) * sizeof(uint16_T *));
+
+    /* sizes and bounding boxes */
+    for (k = 0; k < nobj; k++) {
+        bbox[k] = bbox[nobj + k] = bbox[2 * nobj + k] = mxGetInf();
+        bbox[3 * nobj + k] = bbox[4 * nobj + k] = bbox[5 * nobj + k] = 0.0;
+    }
+    for (z = 0, p = 0; z < slices; z++) {
+        for (c = 0; c < cols; c++) {
+            for (r = 0; r < rows; r++, p++) {
+                if (L[p] == 0)
+                    continue;
+                k = L[p] - 1;
+                sizes[k]++;
+                if (r + 1 < bbox[k]) bbox[k] = (double) (r + 1);
+                if (c + 1 < bbox[nobj + k]) bbox[nobj + k] = (double) (c + 1);
+                if (z + 1 < bbox[2 * nobj + k]) bbox[2 * nobj + k] = (double) (z + 1);
+                if (r + 1 > bbox[3 * nobj + k]) bbox[3 * nobj + k] = (double) (r + 1);
+                if (c + 1 > bbox[4 * nobj + k]) bbox[4 * nobj + k] = (double) (c + 1);
+                if (z + 1 > bbox[5 * nobj + k]) bbox[5 * nobj + k] = (double) (z + 1);
+            }
+        }
+    }
+
+    /* voxel lists */
+    for (k = 0; k < nobj; k++) {
+        mxArray *list = mxCreateNumericMatrix(3, (mwSize) sizes[k],
+                                              mxUINT16_CLASS, mxREAL);
+        voxels[k] = (uint16_T *) mxGetData(list);
+        mxSetCell(plhs[0], k, list);
+    }
+    for (z = 0, p = 0; z < slices; z++) {
+        for (c = 0; c < cols; c++) {
+            for (r = 0; r < rows; r++, p++) {
+                if (L[p] == 0)
+                    continue;
+                k = L[p] - 1;
+                uint16_T *v = voxels[k] + 3 * filled[k]++;
+                v[0] = (uint16_T) (r + 1);
+                v[1] = (uint16_T) (c + 1);
+                v[2] = (uint16_T) (z + 1);
+            }
+        }
+    }
+
+    if (findholes) {
+        uint32_T *BL = (uint32_T *) mxMalloc(N * sizeof(uint32_T) + 1);
+        uint32_T nbg = label_components(B, dims, false, BL);
+        count_holes(L, BL, dims, nobj, nbg, holes);
+        mxFree(BL);
+    } else {
+        for (k = 0; k < nobj; k++)
+            holes[k] = mxGetNaN();
+    }
+
+    if (nlhs > 4)
+        plhs[4] = labels;
+    else
+        mxDestroyArray(labels);
+
+    mxFree(filled);
+    mxFree(voxels);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mwSize dims[3] = {1, 1, 1};
+    const mwSize *d;
+    mwSize ndims, k;
+    bool findholes = false;
+    mxArray *outputs[5];
+    void *B;
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgTxt("[VOXELS, SIZES, BBOXES, HOLES, L] = ml_3dconncomp(BINIMG, "
+                     "FINDHOLES), connected components of a 3D image.");
+    } else if (nlhs > 5) {
+        mexErrMsgTxt("ml_3dconncomp returns at most five outputs.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if ((!mxIsNumeric(prhs[0]) && !mxIsLogical(prhs[0])) ||
+        mxIsComplex(prhs[0]) || ndims > 3) {
+        mexErrMsgTxt("BINIMG must be a real 2D or 3D matrix.");
+    }
+    d = mxGetDimensions(prhs[0]);
+    for (k = 0; k < ndims; k++) {
+        dims[k] = d[k];
+        if (d[k] > 65535) {
+            mexErrMsgTxt("BINIMG is too large for uint16 voxel coordinates.");
+        }
+    }
+    if (nrhs > 1 && !mxIsEmpty(prhs[1]))
+        findholes = (mxGetScalar(prhs[1]) != 0.0);
+
+    B = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        compute_conncomp((const double *) B, dims, ndims, findholes, nlhs, outputs);
+        break;
+    case mxUINT16_CLASS:
+        compute_conncomp((const uint16_T *) B, dims, ndims, findholes, nlhs, outputs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_conncomp((const uint8_T *) B, dims, ndims, findholes, nlhs, outputs);
+        break;
+    default:
+        mexErrMsgTxt("BINIMG must be of class logical, uint8, uint16 or double.");
+    }
+
+    for (k = 0; k < 5; k++) {
+        if (k < (mwSize) nlhs || (k == 0 && nlhs == 0))
+            plhs[k] = outputs[k];
+        else if (k < 4)
+            mxDestroyArray(outputs[k]);
+    }
+}
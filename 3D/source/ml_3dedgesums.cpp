@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_3dedgesums.cpp
+//
+//  Slice by slice Sobel edges of a 3D mask and the pixel and
+//  fluorescence sums used by ml_3dedgefeatures, in one pass.
+//
+//  [EDGEPIX, EDGEFLUOR, PIXELS, FLUOR, EDGES] = ml_3dedgesums(IMAGE, MASK)
+//  where:
+//     -IMAGE is a 2D or 3D image (uint8, uint16, int32, single or double)
+//     -MASK is a binary image with size==IMAGE (logical, uint8, uint16
+//      or double); every nonzero voxel is foreground
+//     -EDGEPIX is the number of edge pixels over all slices
+//     -EDGEFLUOR is the sum of IMAGE over the edge pixels
+//     -PIXELS is the number of foreground voxels of MASK
+//     -FLUOR is the sum of IMAGE over the foreground voxels
+//     -EDGES (optional) is the logical edge volume
+//
+//  The edges of each slice are those of edge(MASK(:,:,z)) with its
+//  defaults: Sobel gradients with replicated borders, threshold
+//  sqrt(4*mean(gradient^2)) and thinning to the local maxima along the
+//  dominant gradient direction.  The gradients of a binary slice are
+//  small integers, so everything is computed exactly in integers; a
+//  slice needs one byte per pixel of working memory.  Slices are
+//  processed in parallel with OpenMP.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename M_T>
+static inline int sobel_x(const M_T *M, mwSize rows, mwSize rm, mwSize r,
+                          mwSize rp, mwSize cm, mwSize cp)
+{
+    return ((M[cm * rows + rm] != 0) + 2 * (M[cm * rows + r] != 0) +
+            (M[cm * rows + rp] != 0)) -
+           ((M[cp * rows + rm] != 0) + 2 * (M[cp * rows + r] != 0) +
+            (M[cp * rows + rp] != 0));
+}
+
+template<typename M_T>
+static inline int sobel_y(const M_T *M, mwSize rows, mwSize rm, mwSize rp,
+                          mwSize cm, mwSize c, mwSize cp)
+{
+    return ((M[cm * rows + rm] != 0) + 2 * (M[c * rows + rm] != 0) +
+            (M[cp * rows + rm] != 0)) -
+           ((M[cm * rows + rp] != 0) + 2 * (M[c * rows + rp] != 0) +
+            (M[cp * rows + rp] != 0));
+}
+
+//
+// Edges of one slice; G is the slice of working memory.  Adds to the
+// sums and writes E if it is not NULL.
+//
+template<typename I_T, typename M_T>
+static void slice_edges(const I_T *I, const M_T *M, mwSize rows, mwSize cols,
+                        unsigned char *G, mxLogical *E, double *edgepix,
+                        double *edgefluor, double *pixels, double *fluor)
+{
+    mwSize r, c, p;
+    long long gsum = 0;
+
+    /* squared gradient magnitude, at most 32 for a binary slice */
+    for (c = 0; c < cols; c++) {
+        mwSize cm = (c > 0) ? c - 1 : 0, cp = (c + 1 < cols) ? c + 1 : c;
+        for (r = 0; r < rows; r++) {
+            mwSize rm = (r > 0) ? r - 1 : 0, rp = (r + 1 < rows) ? r + 1 : r;
+            int gx = sobel_x(M, rows, rm, r, rp, cm, cp);
+            int gy = sobel_y(M, rows, rm, rp, cm, c, cp);
+
+            p = c * rows + r;
+            G[p] = (unsigned char) (gx * gx + gy * gy);
+            gsum += G[p];
+            if (M[p] != 0) {
+                *pixels += 1.0;
+                *fluor += (double) I[p];
+            }
+        }
+    }
+
+    /* G > 4 * mean(G), kept exact by multiplying through by rows*cols */
+    long long npix = (long long) rows * cols;
+    long long cutoff = 4 * gsum;
+
+    for (c = 1; c + 1 < cols; c++) {
+        for (r = 1; r + 1 < rows; r++) {
+            int g, gx, gy;
+
+            p = c * rows + r;
+            g = G[p];
+            if (g * npix <= cutoff)
+                continue;
+            gx = sobel_x(M, rows, r - 1, r, r + 1, c - 1, c + 1);
+            gy = sobel_y(M, rows, r - 1, r + 1, c - 1, c, c + 1);
+            if (gx < 0)
+                gx = -gx;
+            if (gy < 0)
+                gy = -gy;
+
+            if ((gx >= gy && G[p - rows] <= g && g > G[p + rows]) ||
+                (gy >= gx && G[p - 1] <= g && g > G[p + 1])) {
+                *edgepix += 1.0;
+                *edgefluor += (double) I[p];
+                if (E != NULL)
+                    E[p] = 1;
+            }
+        }
+    }
+}
+
+template<typename I_T, typename M_T>
+static void compute_edgesums(const I_T *I, const M_T *M, mwSize rows,
+                             mwSize cols, mwSize slices, mxLogical *E,
+                             double *sums)
+{
+    mwSize npix = rows * cols;
+    double edgepix = 0.0, edgefluor = 0.0, pixels = 0.0, fluor = 0.0;
+    int nthreads = 1;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    /* one slice of working memory per thread */
+    unsigned char *work = (unsigned char *) mxMalloc(npix * nthreads + 1);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads) \
+    reduction(+:edgepix, edgefluor, pixels, fluor)
+#endif
+    {
+        unsigned char *G = work;
+        long z;
+
+#ifdef _OPENMP
+        G += npix * omp_get_thread_num();
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (z = 0; z < (long) slices; z++) {
+            slice_edges(I + (mwSize) z * npix, M + (mwSize) z * npix, rows,
+                        cols, G, E ? E + (mwSize) z * npix : NULL, &edgepix,
+                        &edgefluor, &pixels, &fluor);
+        }
+    }
+
+    sums[0] = edgepix;
+    sums[1] = edgefluor;
+    sums[2] = pixels;
+    sums[3] = fluor;
+    mxFree(work);
+}
+
+template<typename I_T>
+static void dispatch_mask(const I_T *I, const mxArray *mask, mwSize rows,
+                          mwSize cols, mwSize slices, mxLogical *E,
+                          double *sums)
+{
+    void *M = mxGetData(mask);
+
+    switch (mxGetClassID(mask)) {
+    case mxDOUBLE_CLASS:
+        compute_edgesums(I, (const double *) M, rows, cols, slices, E, sums);
+        break;
+    case mxUINT16_CLASS:
+        compute_edgesums(I, (const uint16_T *) M, rows, cols, slices, E, sums);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_edgesums(I, (const uint8_T *) M, rows, cols, slices, E, sums);
+        break;
+    default:
+        mexErrMsgTxt("MASK must be of class logical, uint8, uint16 or double.");
+    }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const mwSize *dims;
+    mwSize ndims, rows, cols, slices;
+    mxLogical *E = NULL;
+    double sums[4];
+    void *I;
+    int k;
+
+    if (nrhs != 2) {
+        mexErrMsgTxt("[EDGEPIX, EDGEFLUOR, PIXELS, FLUOR, EDGES] = "
+                     "ml_3dedgesums(IMAGE, MASK), edge sums of a 3D image.");
+    } else if (nlhs > 5) {
+        mexErrMsgTxt("ml_3dedgesums returns at most five outputs.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if (!mxIsNumeric(prhs[0]) || mxIsComplex(prhs[0]) || ndims > 3) {
+        mexErrMsgTxt("IMAGE must be a real 2D or 3D matrix.");
+    }
+    if (mxGetNumberOfDimensions(prhs[1]) != ndims ||
+        memcmp(mxGetDimensions(prhs[1]), mxGetDimensions(prhs[0]),
+               ndims * sizeof(mwSize)) != 0) {
+        mexErrMsgTxt("MASK must be the same size as IMAGE.");
+    }
+
+    dims = mxGetDimensions(prhs[0]);
+    rows = dims[0];
+    cols = dims[1];
+    slices = (ndims == 3) ? dims[2] : 1;
+
+    if (nlhs > 4) {
+        plhs[4] = mxCreateLogicalArray(ndims, dims);
+        E = mxGetLogicals(plhs[4]);
+    }
+
+    I = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        dispatch_mask((const double *) I, prhs[1], rows, cols, slices, E, sums);
+        break;
+    case mxSINGLE_CLASS:
+        dispatch_mask((const float *) I, prhs[1], rows, cols, slices, E, sums);
+        break;
+    case mxINT32_CLASS:
+        dispatch_mask((const int32_T *) I, prhs[1], rows, cols, slices, E, sums);
+        break;
+    case mxUINT16_CLASS:
+        dispatch_mask((const uint16_T *) I, prhs[1], rows, cols, slices, E, sums);
+        break;
+    case mxUINT8_CLASS:
+        dispatch_mask((const uint8_T *) I, prhs[1], rows, cols, slices, E, sums);
+        break;
+    default:
+        mexErrMsgTxt("IMAGE must be of class double, single, int32, uint16 "
+                     "or uint8.");
+    }
+
+    for (k = 0; k < 4 && (k < nlhs || k == 0); k++)
+        plhs[k] = mxCreateDoubleScalar(sums[k]);
+}
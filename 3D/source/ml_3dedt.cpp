@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                            ml_3dedt.cpp
+//
+//  Exact Euclidean distance transform of a 2D or 3D binary image and
+//  the mean of the distances weighted by an intensity image.
+//
+//  [WMEAN, D] = ml_3dedt(BW, W, SPACING)
+//  where:
+//     -BW is a 2D or 3D binary image (logical, uint8, uint16 or double);
+//      every nonzero voxel is a feature voxel
+//     -W (optional) is a weight image with size==BW (uint8, uint16,
+//      single or double), or [] for weights of 1
+//     -SPACING (optional) is the voxel size [row col slice]; default
+//      [1 1 1]
+//     -WMEAN is mean(W(:) .* D(:)) (NaN if BW has no feature voxel and
+//      some weight is 0, as in MATLAB)
+//     -D (optional) is the single precision distance of every voxel to
+//      the nearest feature voxel, as returned by bwdist(BW) for unit
+//      spacing.  If BW has no feature voxel every distance is Inf.
+//
+//  The transform is separable (Felzenszwalb and Huttenlocher, "Distance
+//  transforms of sampled functions," Theory of Computing 8, 2012): a
+//  two-scan pass along the rows gives 1D distances and each further
+//  dimension takes the lower envelope of parabolas of the previous
+//  squared distances, in linear time per line.  Lines are processed in
+//  parallel with OpenMP.  The last pass multiplies by W and accumulates
+//  the mean directly, so D is only built when it is requested; the
+//  squared distances of the earlier passes are kept in one double
+//  volume.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* per-thread scratch of the lower envelope */
+typedef struct Envelope_tag
+{
+    double *f;      /* squared distances along the line */
+    double *out;    /* result of the line */
+    long   *v;      /* parabolas of the envelope */
+    double *z;      /* boundaries between them */
+} Envelope_T;
+
+//
+// Squared distances along one line of n samples, spacing h, from the
+// squared distances f of the previous passes (HUGE_VAL where there is
+// no feature voxel yet); mx functions are avoided as this runs in the
+// parallel regions
+//
+static void lower_envelope(const double *f, long n, double h, Envelope_T *env)
+{
+    long *v = env->v;
+    double *z = env->z;
+    double *out = env->out;
+    long k = -1, q;
+
+    for (q = 0; q < n; q++) {
+        double fq, s;
+
+        if (f[q] >= HUGE_VAL)
+            continue;
+        fq = f[q] + (q * h) * (q * h);
+        while (k >= 0) {
+            long p = v[k];
+            s = (fq - (f[p] + (p * h) * (p * h))) / (2.0 * h * (q - p));
+            if (s > z[k])
+                break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = (k == 0) ? -HUGE_VAL : s;
+    }
+
+    if (k < 0) {
+        for (q = 0; q < n; q++)
+            out[q] = HUGE_VAL;
+        return;
+    }
+
+    long j = 0;
+    for (q = 0; q < n; q++) {
+        double x = q * h, dx;
+
+        while (j < k && z[j + 1] < x)
+            j++;
+        dx = x - v[j] * h;
+        out[q] = dx * dx + f[v[j]];
+    }
+}
+
+//
+// First pass: squared distance to the nearest feature voxel in the
+// same column
+//
+template<typename B_T>
+static void first_pass(const B_T *BW, mwSize rows, mwSize nlines, double h,
+                       double *G)
+{
+    long line;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (line = 0; line < (long) nlines; line++) {
+        const B_T *b = BW + (mwSize) line * rows;
+        double *g = G + (mwSize) line * rows;
+        long r, last = -1;
+
+        for (r = 0; r < (long) rows; r++) {
+            if (b[r] != 0)
+                last = r;
+            g[r] = (last < 0) ? HUGE_VAL : (double) (r - last);
+        }
+        last = -1;
+        for (r = (long) rows - 1; r >= 0; r--) {
+            if (b[r] != 0)
+                last = r;
+            if (last >= 0 && last - r < g[r])
+                g[r] = (double) (last - r);
+            g[r] = g[r] * h;
+            g[r] = g[r] * g[r];
+        }
+    }
+}
+
+template<typename W_T>
+static inline double weight_at(const W_T *W, mwSize p)
+{
+    return (W == NULL) ? 1.0 : (double) W[p];
+}
+
+//
+// Lower envelope along dimension dim of G.  The last pass (final)
+// returns the sum of W.*D and writes D when it is not NULL; the others
+// write the squared distances back into G.
+//
+template<typename W_T>
+static double envelope_pass(double *G, const mwSize *dims, int dim, double h,
+                            bool final, const W_T *W, float *D,
+                            Envelope_T *envs, int nthreads)
+{
+    mwSize n = dims[dim];
+    mwSize stride = (dim == 0) ? 1 : (dim == 1) ? dims[0] : dims[0] * dims[1];
+    mwSize inner = stride, outer = dims[0] * dims[1] * dims[2] / (stride * n);
+    double wsum = 0.0;
+    long line;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(nthreads) \
+    reduction(+:wsum)
+#endif
+    for (line = 0; line < (long) (inner * outer); line++) {
+        Envelope_T *env = envs;
+        mwSize base = ((mwSize) line / inner) * inner * n + (mwSize) line % inner;
+        mwSize i, p;
+
+#ifdef _OPENMP
+        env += omp_get_thread_num();
+#endif
+        for (i = 0, p = base; i < n; i++, p += stride)
+            env->f[i] = G[p];
+        lower_envelope(env->f, (long) n, h, env);
+
+        for (i = 0, p = base; i < n; i++, p += stride) {
+            if (!final) {
+                G[p] = env->out[i];
+            } else {
+                double d = sqrt(env->out[i]);
+                double w = weight_at(W, p);
+                wsum += w * d;
+                if (D != NULL)
+                    D[p] = (float) d;
+            }
+        }
+    }
+
+    return wsum;
+}
+
+template<typename B_T, typename W_T>
+static double compute_edt(const B_T *BW, const W_T *W, const mwSize *dims,
+                          const double *spacing, float *D)
+{
+    mwSize N = dims[0] * dims[1] * dims[2], maxn = 0;
+    int nthreads = 1, t, dim, last;
+    double wsum = 0.0;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    for (dim = 0; dim < 3; dim++)
+        if (dims[dim] > maxn)
+            maxn = dims[dim];
+    last = (dims[2] > 1) ? 2 : (dims[1] > 1) ? 1 : 0;
+
+    double *G = (double *) mxMalloc(N * sizeof(double) + 1);
+    Envelope_T *envs = (Envelope_T *) mxMalloc(nthreads * sizeof(Envelope_T));
+    for (t = 0; t < nthreads; t++) {
+        envs[t].f = (double *) mxMalloc(maxn * sizeof(double));
+        envs[t].out = (double *) mxMalloc(maxn * sizeof(double));
+        envs[t].v = (long *) mxMalloc(maxn * sizeof(long));
+        envs[t].z = (double *) mxMalloc(maxn * sizeof(double));
+    }
+
+    first_pass(BW, dims[0], N / dims[0], spacing[0], G);
+    if (last == 0) {
+        /* a column vector: the first pass is the whole transform */
+        mwSize p;
+        for (p = 0; p < N; p++) {
+            double d = sqrt(G[p]), w = weight_at(W, p);
+            wsum += w * d;
+            if (D != NULL)
+                D[p] = (float) d;
+        }
+    }
+    for (dim = 1; dim <= last; dim++) {
+        wsum = envelope_pass(G, dims, dim, spacing[dim], dim == last, W, D,
+                             envs, nthreads);
+    }
+
+    for (t = 0; t < nthreads; t++) {
+        mxFree(envs[t].f);
+        mxFree(envs[t].out);
+        mxFree(envs[t].v);
+        mxFree(envs[t].z);
+    }
+    mxFree(envs);
+    mxFree(G);
+
+    return wsum / (double) N;
+}
+
+template<typename B_T>
+static double dispatch_weights(const B_T *BW, const mxArray *weights,
+                               const mwSize *dims, const double *spacing,
+                               float *D)
+{
+    void *W;
+
+    if (weights == NULL)
+        return compute_edt(BW, (const double *) NULL, dims, spacing, D);
+
+    W = mxGetData(weights);
+    switch (mxGetClassID(weights)) {
+    case mxDOUBLE_CLASS:
+        return compute_edt(BW, (const double *) W, dims, spacing, D);
+    case mxSINGLE_CLASS:
+        return compute_edt(BW, (const float *) W, dims, spacing, D);
+    case mxUINT16_CLASS:
+        return compute_edt(BW, (const uint16_T *) W, dims, spacing, D);
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        return compute_edt(BW, (const uint8_T *) W, dims, spacing, D);
+    default:
+        mexErrMsgTxt("W must be of class double, single, uint16, uint8 or "
+                     "logical.");
+    }
+    return 0.0;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const mxArray *weights = NULL;
+    double spacing[3] = {1.0, 1.0, 1.0};
+    mwSize dims[3] = {1, 1, 1};
+    const mwSize *d;
+    mwSize ndims, k;
+    float *D = NULL;
+    double wmean = 0.0;
+    void *BW;
+
+    if (nrhs < 1 || nrhs > 3) {
+        mexErrMsgTxt("[WMEAN, D] = ml_3dedt(BW, W, SPACING), weighted mean of "
+                     "the Euclidean distance transform.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_3dedt returns at most two outputs.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if ((!mxIsNumeric(prhs[0]) && !mxIsLogical(prhs[0])) ||
+        mxIsComplex(prhs[0]) || ndims > 3) {
+        mexErrMsgTxt("BW must be a real 2D or 3D matrix.");
+    }
+    d = mxGetDimensions(prhs[0]);
+    for (k = 0; k < ndims; k++)
+        dims[k] = d[k];
+    if (mxIsEmpty(prhs[0])) {
+        mexErrMsgTxt("BW must not be empty.");
+    }
+
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+        weights = prhs[1];
+        if (mxIsComplex(weights) ||
+            mxGetNumberOfDimensions(weights) != ndims ||
+            memcmp(mxGetDimensions(weights), d, ndims * sizeof(mwSize)) != 0) {
+            mexErrMsgTxt("W must be a real matrix the same size as BW.");
+        }
+    }
+
+    if (nrhs > 2 && !mxIsEmpty(prhs[2])) {
+        if (!mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) < ndims ||
+            mxGetNumberOfElements(prhs[2]) > 3) {
+            mexErrMsgTxt("SPACING must be a double vector with one element "
+                         "per dimension of BW.");
+        }
+        for (k = 0; k < mxGetNumberOfElements(prhs[2]); k++) {
+            spacing[k] = mxGetPr(prhs[2])[k];
+            if (!(spacing[k] > 0.0) || !mxIsFinite(spacing[k])) {
+                mexErrMsgTxt("SPACING must be positive and finite.");
+            }
+        }
+    }
+
+    if (nlhs > 1) {
+        plhs[1] = mxCreateNumericArray(ndims, d, mxSINGLE_CLASS, mxREAL);
+        D = (float *) mxGetData(plhs[1]);
+    }
+
+    BW = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        wmean = dispatch_weights((const double *) BW, weights, dims, spacing, D);
+        break;
+    case mxUINT16_CLASS:
+        wmean = dispatch_weights((const uint16_T *) BW, weights, dims, spacing, D);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        wmean = dispatch_weights((const uint8_T *) BW, weights, dims, spacing, D);
+        break;
+    default:
+        mexErrMsgTxt("BW must be of class logical, uint8, uint16 or double.");
+    }
+
+    plhs[0] = mxCreateDoubleScalar(wmean);
+}
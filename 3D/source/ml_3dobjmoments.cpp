@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_3dobjmoments.cpp
+//
+//  Raw and central moments up to order 4 of every object in a 3D
+//  image, in one pass; 3D counterpart of ml_objmoments.
+//
+//  [M, MU, COUNT] = ml_3dobjmoments(IMAGE, LABELED)
+//  where:
+//     -IMAGE is a 3D image (uint8, uint16, int32, single, double or
+//      logical)
+//     -LABELED (optional) is a label volume with size==IMAGE (double,
+//      int32, uint32, uint16, uint8 or logical); label 0 is background.
+//      If omitted or [], the whole image is one object.
+//     -M is an N x 35 matrix of raw moments m_pqr, N = max(LABELED(:)),
+//      ordered by degree d = p+q+r = 0..4 and within a degree by
+//      for p=d:-1:0, for q=d-p:-1:0, r=d-p-q, i.e.
+//      [m000 m100 m010 m001 m200 m110 m101 m020 m011 m002 ...]
+//      x is the (1-based) column, y the row and z the slice.
+//     -MU is an N x 35 matrix of the central moments mu_pqr about the
+//      center of fluorescence, in the same order.  Objects with
+//      m000 == 0 get NaN central moments.
+//     -COUNT is an N x 1 vector with the number of voxels of each label
+//
+//  Sums are accumulated about the first voxel of each object, which
+//  keeps the powers small, and shifted to the image origin and to the
+//  center of fluorescence at the end.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+
+#define MAX_MOMENT_ORDER 4
+#define NUM_MOMENTS 35
+
+/* column of m_pqr, filled by make_moment_index */
+static int moment_index[MAX_MOMENT_ORDER + 1][MAX_MOMENT_ORDER + 1][MAX_MOMENT_ORDER + 1];
+
+#define MOMENT_INDEX(p, q, r) (moment_index[p][q][r])
+
+typedef struct ObjectMoments_tag
+{
+    double ref_x;              /* origin of the sums */
+    double ref_y;
+    double ref_z;
+    bool   has_ref;
+    double sum[NUM_MOMENTS];   /* moments about (ref_x, ref_y, ref_z) */
+    double count;
+} ObjectMoments_T;
+
+static const double binomial[MAX_MOMENT_ORDER + 1][MAX_MOMENT_ORDER + 1] = {
+    {1, 0, 0, 0, 0},
+    {1, 1, 0, 0, 0},
+    {1, 2, 1, 0, 0},
+    {1, 3, 3, 1, 0},
+    {1, 4, 6, 4, 1}
+};
+
+static void make_moment_index(void)
+{
+    int d, p, q, idx = 0;
+
+    for (d = 0; d <= MAX_MOMENT_ORDER; d++)
+        for (p = d; p >= 0; p--)
+            for (q = d - p; q >= 0; q--)
+                moment_index[p][q][d - p - q] = idx++;
+}
+
+//
+// Moments about (ax, ay, az) from the sums about the object's reference
+//
+static void shift_moments(const ObjectMoments_T *obj, double ax, double ay,
+                          double az, double *out)
+{
+    double dx[MAX_MOMENT_ORDER + 1], dy[MAX_MOMENT_ORDER + 1];
+    double dz[MAX_MOMENT_ORDER + 1];
+    int p, q, r, i, j, k;
+
+    dx[0] = dy[0] = dz[0] = 1.0;
+    for (i = 1; i <= MAX_MOMENT_ORDER; i++) {
+        dx[i] = dx[i - 1] * (obj->ref_x - ax);
+        dy[i] = dy[i - 1] * (obj->ref_y - ay);
+        dz[i] = dz[i - 1] * (obj->ref_z - az);
+    }
+
+    for (p = 0; p <= MAX_MOMENT_ORDER; p++) {
+        for (q = 0; p + q <= MAX_MOMENT_ORDER; q++) {
+            for (r = 0; p + q + r <= MAX_MOMENT_ORDER; r++) {
+                double value = 0.0;
+                for (i = 0; i <= p; i++)
+                    for (j = 0; j <= q; j++)
+                        for (k = 0; k <= r; k++)
+                            value += binomial[p][i] * binomial[q][j] *
+                                binomial[r][k] * dx[p - i] * dy[q - j] *
+                                dz[r - k] * obj->sum[MOMENT_INDEX(i, j, k)];
+                out[MOMENT_INDEX(p, q, r)] = value;
+            }
+        }
+    }
+}
+
+template<typename L_T>
+static inline mwSize label_at(const L_T *L, mwSize p)
+{
+    double v;
+
+    if (L == NULL)
+        return 1;
+    v = (double) L[p];
+    return (v >= 1.0) ? (mwSize) v : 0;
+}
+
+template<typename I_T, typename L_T>
+static void accumulate_moments(const I_T *I, const L_T *L, mwSize rows,
+                               mwSize cols, mwSize slices,
+                               ObjectMoments_T *objects)
+{
+    double px[MAX_MOMENT_ORDER + 1], py[MAX_MOMENT_ORDER + 1];
+    double pz[MAX_MOMENT_ORDER + 1];
+    mwSize r, c, s, p = 0;
+    int i, j, k;
+
+    for (s = 0; s < slices; s++) {
+        for (c = 0; c < cols; c++) {
+            for (r = 0; r < rows; r++, p++) {
+                mwSize label = label_at(L, p);
+                ObjectMoments_T *obj;
+                double w;
+
+                if (label == 0)
+                    continue;
+                obj = &objects[label];
+                obj->count++;
+                if (!obj->has_ref) {
+                    obj->ref_x = (double) (c + 1);
+                    obj->ref_y = (double) (r + 1);
+                    obj->ref_z = (double) (s + 1);
+                    obj->has_ref = true;
+                }
+
+                w = (double) I[p];
+                if (w == 0.0)
+                    continue;
+
+                px[0] = w;
+                py[0] = pz[0] = 1.0;
+                for (i = 1; i <= MAX_MOMENT_ORDER; i++) {
+                    px[i] = px[i - 1] * ((double) (c + 1) - obj->ref_x);
+                    py[i] = py[i - 1] * ((double) (r + 1) - obj->ref_y);
+                    pz[i] = pz[i - 1] * ((double) (s + 1) - obj->ref_z);
+                }
+                for (i = 0; i <= MAX_MOMENT_ORDER; i++)
+                    for (j = 0; i + j <= MAX_MOMENT_ORDER; j++) {
+                        double pxy = px[i] * py[j];
+                        for (k = 0; i + j + k <= MAX_MOMENT_ORDER; k++)
+                            obj->sum[MOMENT_INDEX(i, j, k)] += pxy * pz[k];
+                    }
+            }
+        }
+    }
+}
+
+template<typename L_T>
+static mwSize max_label(const L_T *L, mwSize N)
+{
+    mwSize nobj = 0, p, k;
+
+    if (L == NULL)
+        return 1;
+    for (p = 0; p < N; p++) {
+        k = label_at(L, p);
+        if (k > nobj)
+            nobj = k;
+    }
+    return nobj;
+}
+
+template<typename I_T, typename L_T>
+static void compute_objmoments(const I_T *I, const L_T *L, const mwSize *dims,
+                               mxArray *plhs[])
+{
+    mwSize nobj = max_label(L, dims[0] * dims[1] * dims[2]);
+    ObjectMoments_T *objects =
+        (ObjectMoments_T *) mxCalloc(nobj + 1, sizeof(ObjectMoments_T));
+    double raw[NUM_MOMENTS], central[NUM_MOMENTS];
+    mwSize k;
+    int j;
+
+    accumulate_moments(I, L, dims[0], dims[1], dims[2], objects);
+
+    plhs[0] = mxCreateDoubleMatrix(nobj, NUM_MOMENTS, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(nobj, NUM_MOMENTS, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(nobj, 1, mxREAL);
+    double *M = mxGetPr(plhs[0]);
+    double *MU = mxGetPr(plhs[1]);
+    double *count = mxGetPr(plhs[2]);
+
+    for (k = 1; k <= nobj; k++) {
+        ObjectMoments_T *obj = &objects[k];
+        double m000 = obj->sum[MOMENT_INDEX(0, 0, 0)];
+
+        shift_moments(obj, 0.0, 0.0, 0.0, raw);
+        if (m000 != 0.0) {
+            shift_moments(obj,
+                          obj->ref_x + obj->sum[MOMENT_INDEX(1, 0, 0)] / m000,
+                          obj->ref_y + obj->sum[MOMENT_INDEX(0, 1, 0)] / m000,
+                          obj->ref_z + obj->sum[MOMENT_INDEX(0, 0, 1)] / m000,
+                          central);
+        } else {
+            for (j = 0; j < NUM_MOMENTS; j++)
+                central[j] = mxGetNaN();
+        }
+
+        for (j = 0; j < NUM_MOMENTS; j++) {
+            M[(mwSize) j * nobj + k - 1] = raw[j];
+            MU[(mwSize) j * nobj + k - 1] = central[j];
+        }
+        count[k - 1] = obj->count;
+    }
+
+    mxFree(objects);
+}
+
+template<typename I_T>
+static void dispatch_labels(const I_T *I, const mxArray *labeled,
+                            const mwSize *dims, mxArray *plhs[])
+{
+    void *L;
+
+    if (labeled == NULL || mxIsEmpty(labeled)) {
+        compute_objmoments(I, (const uint8_T *) NULL, dims, plhs);
+        return;
+    }
+
+    L = mxGetData(labeled);
+    switch (mxGetClassID(labeled)) {
+    case mxDOUBLE_CLASS:
+        compute_objmoments(I, (const double *) L, dims, plhs);
+        break;
+    case mxINT32_CLASS:
+        compute_objmoments(I, (const int32_T *) L, dims, plhs);
+        break;
+    case mxUINT32_CLASS:
+        compute_objmoments(I, (const uint32_T *) L, dims, plhs);
+        break;
+    case mxUINT16_CLASS:
+        compute_objmoments(I, (const uint16_T *) L, dims, plhs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_objmoments(I, (const uint8_T *) L, dims, plhs);
+        break;
+    default:
+        mexErrMsgTxt("LABELED must be of class double, int32, uint32, "
+                     "uint16, uint8 or logical.");
+    }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mxArray *outputs[3];
+    const mxArray *labeled = NULL;
+    const mwSize *d;
+    mwSize dims[3];
+    mwSize nd;
+    void *I;
+    int k;
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgTxt("[M, MU, COUNT] = ml_3dobjmoments(IMAGE, LABELED), raw and "
+                     "central moments up to order 4 of every object.");
+    } else if (nlhs > 3) {
+        mexErrMsgTxt("ml_3dobjmoments returns at most three outputs.");
+    }
+
+    nd = mxGetNumberOfDimensions(prhs[0]);
+    if ((!mxIsNumeric(prhs[0]) && !mxIsLogical(prhs[0])) ||
+        mxIsComplex(prhs[0]) || nd > 3) {
+        mexErrMsgTxt("IMAGE must be a real 3D matrix.");
+    }
+
+    d = mxGetDimensions(prhs[0]);
+    dims[0] = d[0];
+    dims[1] = d[1];
+    dims[2] = (nd == 3) ? d[2] : 1;
+
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+        labeled = prhs[1];
+        if (mxGetNumberOfDimensions(labeled) != nd ||
+            memcmp(mxGetDimensions(labeled), d, nd * sizeof(mwSize)) != 0) {
+            mexErrMsgTxt("LABELED must be the same size as IMAGE.");
+        }
+    }
+
+    make_moment_index();
+
+    I = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        dispatch_labels((const double *) I, labeled, dims, outputs);
+        break;
+    case mxSINGLE_CLASS:
+        dispatch_labels((const float *) I, labeled, dims, outputs);
+        break;
+    case mxINT32_CLASS:
+        dispatch_labels((const int32_T *) I, labeled, dims, outputs);
+        break;
+    case mxUINT16_CLASS:
+        dispatch_labels((const uint16_T *) I, labeled, dims, outputs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        dispatch_labels((const uint8_T *) I, labeled, dims, outputs);
+        break;
+    default:
+        mexErrMsgTxt("IMAGE must be of class double, single, int32, uint16, "
+                     "uint8 or logical.");
+    }
+
+    for (k = 0; k < 3; k++) {
+        if (k < nlhs || (k == 0 && nlhs == 0))
+            plhs[k] = outputs[k];
+        else
+            mxDestroyArray(outputs[k]);
+    }
+}
@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_3dobjstats.cpp
+//
+//  Per-object 3D descriptors used by the SLF object features
+//  (ml_obj2feat): size, center of fluorescence, distances to the
+//  protein and DNA centers of fluorescence and inertia tensor shape.
+//
+//  [STATS, COFS] = ml_3dobjstats(LABELED, PROTIMG, DNA, SCALE, SCALEDIST)
+//  where:
+//     -LABELED is a 3D label volume (double, int32, uint32, uint16, uint8
+//      or logical); label 0 is background
+//     -PROTIMG is the protein image with size==LABELED (uint8, uint16,
+//      single or double)
+//     -DNA (optional) is the DNA image with size==LABELED, its center of
+//      fluorescence as a 3 element vector [row col slice], or [] for
+//      no DNA
+//     -SCALE (optional) is the voxel size [row col slice] used for the
+//      horizontal and vertical distances and the inertia tensor;
+//      default [1 1 1]
+//     -SCALEDIST (optional) is the voxel size used for the 3D
+//      distances; default SCALE
+//     -STATS is an N x 15 matrix, N = max(LABELED(:)), one row per label:
+//        1      number of voxels
+//        2      sum of PROTIMG over the object
+//        3-5    center of fluorescence [row col slice] (1-based)
+//        6      distance to the protein COF (SCALEDIST)
+//        7      distance to the DNA COF (SCALEDIST)
+//        8, 9   horizontal and vertical distances to the protein COF
+//        10, 11 horizontal and vertical distances to the DNA COF
+//        12-14  eigenvalues of the covariance of the voxel coordinates
+//               (SCALE units), largest first
+//        15     eccentricity sqrt(1 - eig3/eig1)
+//      DNA columns are NaN without DNA, and all but the first two are
+//      NaN for labels with no voxel.
+//     -COFS is the 3 x 2 matrix [protein COF, DNA COF].  The protein COF
+//      is taken over the labeled voxels only, as by ml_findCOFs.
+//
+//  Voxels are bucketed by label and the objects are processed in
+//  parallel with OpenMP.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define NUM_STATS 15
+
+template<typename L_T>
+static inline mwSize label_at(const L_T *L, mwSize p)
+{
+    double v = (double) L[p];
+    return (v >= 1.0) ? (mwSize) v : 0;
+}
+
+//
+// Counting sort of the labeled voxels: the voxels of label k are
+// voxels[start[k]] .. voxels[start[k+1]-1]
+//
+template<typename L_T>
+static mwSize bucket_voxels(const L_T *L, mwSize num_voxels,
+                            mwSize **start, mwSize **voxels)
+{
+    mwSize nobj = 0;
+    mwSize p, k;
+
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k > nobj)
+            nobj = k;
+    }
+
+    /* background voxels are not bucketed; first[1] == 0 */
+    mwSize *first = (mwSize *) mxCalloc(nobj + 2, sizeof(mwSize));
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k != 0)
+            first[k + 1]++;
+    }
+    for (k = 1; k <= nobj + 1; k++)
+        first[k] += first[k - 1];
+
+    mwSize *next = (mwSize *) mxMalloc((nobj + 1) * sizeof(mwSize));
+    mwSize *vox = (mwSize *) mxMalloc((first[nobj + 1] + 1) * sizeof(mwSize));
+    memcpy(next, first, (nobj + 1) * sizeof(mwSize));
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k != 0)
+            vox[next[k]++] = p;
+    }
+    mxFree(next);
+
+    *start = first;
+    *voxels = vox;
+    return nobj;
+}
+
+//
+// Eigenvalues of the symmetric matrix [a d e; d b f; e f c], largest
+// first (trigonometric solution of the characteristic polynomial)
+//
+static void symmetric_eigenvalues(double a, double b, double c, double d,
+                                  double e, double f, double *lambda)
+{
+    double p1 = d * d + e * e + f * f;
+    double q = (a + b + c) / 3.0;
+
+    if (p1 == 0.0) {
+        double t;
+        lambda[0] = a;
+        lambda[1] = b;
+        lambda[2] = c;
+        if (lambda[0] < lambda[1]) { t = lambda[0]; lambda[0] = lambda[1]; lambda[1] = t; }
+        if (lambda[1] < lambda[2]) { t = lambda[1]; lambda[1] = lambda[2]; lambda[2] = t; }
+        if (lambda[0] < lambda[1]) { t = lambda[0]; lambda[0] = lambda[1]; lambda[1] = t; }
+        return;
+    }
+
+    double p2 = (a - q) * (a - q) + (b - q) * (b - q) + (c - q) * (c - q) + 2.0 * p1;
+    double p = sqrt(p2 / 6.0);
+    /* det((A - qI) / p) / 2 */
+    double ba = (a - q) / p, bb = (b - q) / p, bc = (c - q) / p;
+    double bd = d / p, be = e / p, bf = f / p;
+    double r = (ba * (bb * bc - bf * bf) - bd * (bd * bc - bf * be) +
+                be * (bd * bf - bb * be)) / 2.0;
+    double phi;
+
+    if (r <= -1.0)
+        phi = M_PI / 3.0;
+    else if (r >= 1.0)
+        phi = 0.0;
+    else
+        phi = acos(r) / 3.0;
+
+    lambda[0] = q + 2.0 * p * cos(phi);
+    lambda[2] = q + 2.0 * p * cos(phi + 2.0 * M_PI / 3.0);
+    lambda[1] = 3.0 * q - lambda[0] - lambda[2];
+}
+
+//
+// Size, fluorescence, COF and inertia of one object; the sums of the
+// weighted coordinates go to coordsum for the protein COF
+//
+template<typename W_T>
+static void object_stats(const W_T *W, const mwSize *vox, mwSize nvox,
+                         const mwSize *dims, const double *scale,
+                         double *stats, double *coordsum)
+{
+    double g = 0.0, gy = 0.0, gx = 0.0, gz = 0.0;
+    double sy = 0.0, sx = 0.0, sz = 0.0;
+    double syy = 0.0, sxx = 0.0, szz = 0.0, syx = 0.0, syz = 0.0, sxz = 0.0;
+    double ref[3], lambda[3];
+    mwSize i;
+
+    /* binary moments about the first voxel, which keeps them small */
+    ref[0] = (double) (vox[0] % dims[0]);
+    ref[1] = (double) ((vox[0] / dims[0]) % dims[1]);
+    ref[2] = (double) (vox[0] / (dims[0] * dims[1]));
+
+    for (i = 0; i < nvox; i++) {
+        mwSize p = vox[i];
+        double w = (double) W[p];
+        double y = (double) (p % dims[0]) + 1.0;
+        double x = (double) ((p / dims[0]) % dims[1]) + 1.0;
+        double z = (double) (p / (dims[0] * dims[1])) + 1.0;
+        double dy = (y - 1.0 - ref[0]) * scale[0];
+        double dx = (x - 1.0 - ref[1]) * scale[1];
+        double dz = (z - 1.0 - ref[2]) * scale[2];
+
+        g += w;
+        gy += w * y;
+        gx += w * x;
+        gz += w * z;
+        sy += dy;
+        sx += dx;
+        sz += dz;
+        syy += dy * dy;
+        sxx += dx * dx;
+        szz += dz * dz;
+        syx += dy * dx;
+        syz += dy * dz;
+        sxz += dx * dz;
+    }
+
+    double n = (double) nvox;
+    stats[0] = n;
+    stats[1] = g;
+    stats[2] = gy / g;
+    stats[3] = gx / g;
+    stats[4] = gz / g;
+    coordsum[0] = gy;
+    coordsum[1] = gx;
+    coordsum[2] = gz;
+
+    sy /= n;
+    sx /= n;
+    sz /= n;
+    symmetric_eigenvalues(syy / n - sy * sy, sxx / n - sx * sx,
+                          szz / n - sz * sz, syx / n - sy * sx,
+                          syz / n - sy * sz, sxz / n - sx * sz, lambda);
+    stats[11] = lambda[0];
+    stats[12] = lambda[1];
+    stats[13] = lambda[2];
+    stats[14] = (lambda[0] > 0.0) ? sqrt(fmax(0.0, 1.0 - lambda[2] / lambda[0]))
+                                  : 0.0;
+}
+
+//
+// Center of fluorescence of a whole image, as ml_findCOF(ml_sparse(IMG))
+//
+template<typename D_T>
+static void image_cof(const D_T *D, const mwSize *dims, double *cof)
+{
+    mwSize N = dims[0] * dims[1] * dims[2];
+    double g = 0.0, gy = 0.0, gx = 0.0, gz = 0.0;
+    long p;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:g, gy, gx, gz)
+#endif
+    for (p = 0; p < (long) N; p++) {
+        double w = (double) D[p];
+        if (w == 0.0)
+            continue;
+        g += w;
+        gy += w * (double) ((mwSize) p % dims[0] + 1);
+        gx += w * (double) (((mwSize) p / dims[0]) % dims[1] + 1);
+        gz += w * (double) ((mwSize) p / (dims[0] * dims[1]) + 1);
+    }
+    cof[0] = gy / g;
+    cof[1] = gx / g;
+    cof[2] = gz / g;
+}
+
+static void dna_cof(const mxArray *dna, const mwSize *dims, double *cof)
+{
+    void *D = mxGetData(dna);
+
+    switch (mxGetClassID(dna)) {
+    case mxDOUBLE_CLASS:
+        image_cof((const double *) D, dims, cof);
+        break;
+    case mxSINGLE_CLASS:
+        image_cof((const float *) D, dims, cof);
+        break;
+    case mxUINT16_CLASS:
+        image_cof((const uint16_T *) D, dims, cof);
+        break;
+    case mxUINT8_CLASS:
+        image_cof((const uint8_T *) D, dims, cof);
+        break;
+    default:
+        mexErrMsgTxt("DNA must be of class double, single, uint16 or uint8.");
+    }
+}
+
+static double distance(const double *a, const double *b, const double *scale,
+                       int first, int last)
+{
+    double sum = 0.0;
+    int i;
+
+    for (i = first; i <= last; i++)
+        sum += ((a[i] - b[i]) * scale[i]) * ((a[i] - b[i]) * scale[i]);
+    return sqrt(sum);
+}
+
+template<typename L_T, typename W_T>
+static void compute_objstats(const L_T *L, const W_T *W, const mwSize *dims,
+                             const double *scale, const double *scaledist,
+                             const double *dnacof, mxArray **stats_out,
+                             mxArray **cofs_out)
+{
+    mwSize *start, *voxels;
+    mwSize nobj = bucket_voxels(L, dims[0] * dims[1] * dims[2], &start, &voxels);
+    double *coordsum = (double *) mxCalloc(3 * nobj + 1, sizeof(double));
+    double row[NUM_STATS], cof[3], total[4] = {0.0, 0.0, 0.0, 0.0};
+    double nan = mxGetNaN();
+    mwSize k;
+    int j;
+
+    *stats_out = mxCreateDoubleMatrix(nobj, NUM_STATS, mxREAL);
+    *cofs_out = mxCreateDoubleMatrix(3, 2, mxREAL);
+    double *stats = mxGetPr(*stats_out);
+    double *cofs = mxGetPr(*cofs_out);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) private(row, j)
+#endif
+    for (long obj = 0; obj < (long) nobj; obj++) {
+        mwSize nvox = start[obj + 2] - start[obj + 1];
+
+        if (nvox > 0) {
+            object_stats(W, voxels + start[obj + 1], nvox, dims, scale, row,
+                         coordsum + 3 * obj);
+        } else {
+            /* unused label */
+            for (j = 0; j < NUM_STATS; j++)
+                row[j] = (j < 2) ? 0.0 : nan;
+        }
+        for (j = 0; j < NUM_STATS; j++)
+            stats[(mwSize) j * nobj + obj] = row[j];
+    }
+
+    /* protein COF over the objects */
+    for (k = 0; k < nobj; k++) {
+        total[0] += stats[nobj + k];
+        for (j = 0; j < 3; j++)
+            total[j + 1] += coordsum[3 * k + j];
+    }
+    for (j = 0; j < 3; j++) {
+        cofs[j] = total[j + 1] / total[0];
+        cofs[3 + j] = dnacof ? dnacof[j] : mxGetNaN();
+    }
+
+    for (k = 0; k < nobj; k++) {
+        for (j = 0; j < 3; j++)
+            cof[j] = stats[(mwSize) (2 + j) * nobj + k];
+        stats[5 * nobj + k] = distance(cofs, cof, scaledist, 0, 2);
+        stats[7 * nobj + k] = distance(cofs, cof, scale, 0, 1);
+        stats[8 * nobj + k] = distance(cofs, cof, scale, 2, 2);
+        if (dnacof) {
+            stats[6 * nobj + k] = distance(dnacof, cof, scaledist, 0, 2);
+            stats[9 * nobj + k] = distance(dnacof, cof, scale, 0, 1);
+            stats[10 * nobj + k] = distance(dnacof, cof, scale, 2, 2);
+        } else {
+            stats[6 * nobj + k] = stats[9 * nobj + k] =
+                stats[10 * nobj + k] = mxGetNaN();
+        }
+    }
+
+    mxFree(coordsum);
+    mxFree(start);
+    mxFree(voxels);
+}
+
+template<typename W_T>
+static void dispatch_labels(const mxArray *labeled, const W_T *W,
+                            const mwSize *dims, const double *scale,
+                            const double *scaledist, const double *dnacof,
+                            mxArray **stats, mxArray **cofs)
+{
+    void *L = mxGetData(labeled);
+
+    switch (mxGetClassID(labeled)) {
+    case mxDOUBLE_CLASS:
+        compute_objstats((const double *) L, W, dims, scale, scaledist, dnacof, stats, cofs);
+        break;
+    case mxINT32_CLASS:
+        compute_objstats((const int32_T *) L, W, dims, scale, scaledist, dnacof, stats, cofs);
+        break;
+    case mxUINT32_CLASS:
+        compute_objstats((const uint32_T *) L, W, dims, scale, scaledist, dnacof, stats, cofs);
+        break;
+    case mxUINT16_CLASS:
+        compute_objstats((const uint16_T *) L, W, dims, scale, scaledist, dnacof, stats, cofs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_objstats((const uint8_T *) L, W, dims, scale, scaledist, dnacof, stats, cofs);
+        break;
+    default:
+        mexErrMsgTxt("LABELED must be of class double, int32, uint32, uint16, "
+                     "uint8 or logical.");
+    }
+}
+
+static bool same_size(const mxArray *a, const mxArray *b)
+{
+    mwSize nd = mxGetNumberOfDimensions(a);
+
+    return mxGetNumberOfDimensions(b) == nd &&
+        memcmp(mxGetDimensions(a), mxGetDimensions(b), nd * sizeof(mwSize)) == 0;
+}
+
+static void read_scale(const mxArray *arg, const char *msg, double *scale)
+{
+    int k;
+
+    if (!mxIsDouble(arg) || mxGetNumberOfElements(arg) != 3)
+        mexErrMsgTxt(msg);
+    for (k = 0; k < 3; k++)
+        scale[k] = mxGetPr(arg)[k];
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    double scale[3] = {1.0, 1.0, 1.0}, scaledist[3], dnacof[3];
+    const double *dna = NULL;
+    mxArray *stats = NULL, *cofs = NULL;
+    mwSize dims[3], nd;
+    const mwSize *d;
+    void *W;
+
+    if (nrhs < 2 || nrhs > 5) {
+        mexErrMsgTxt("[STATS, COFS] = ml_3dobjstats(LABELED, PROTIMG, DNA, "
+                     "SCALE, SCALEDIST), 3D descriptors of every object.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_3dobjstats returns at most two outputs.");
+    }
+
+    nd = mxGetNumberOfDimensions(prhs[0]);
+    if (nd > 3) {
+        mexErrMsgTxt("LABELED must be a 3D volume.");
+    }
+    d = mxGetDimensions(prhs[0]);
+    dims[0] = d[0];
+    dims[1] = d[1];
+    dims[2] = (nd == 3) ? d[2] : 1;
+
+    if (!same_size(prhs[0], prhs[1]) || mxIsComplex(prhs[1])) {
+        mexErrMsgTxt("PROTIMG must be a real image the same size as LABELED.");
+    }
+
+    if (nrhs > 3 && !mxIsEmpty(prhs[3]))
+        read_scale(prhs[3], "SCALE should be a double vector [row col slice].",
+                   scale);
+    memcpy(scaledist, scale, sizeof(scale));
+    if (nrhs > 4 && !mxIsEmpty(prhs[4]))
+        read_scale(prhs[4], "SCALEDIST should be a double vector [row col "
+                   "slice].", scaledist);
+
+    if (nrhs > 2 && !mxIsEmpty(prhs[2])) {
+        if (mxGetNumberOfElements(prhs[2]) == 3 && mxIsDouble(prhs[2]) &&
+            mxGetNumberOfElements(prhs[0]) != 3) {
+            memcpy(dnacof, mxGetPr(prhs[2]), sizeof(dnacof));
+        } else if (same_size(prhs[0], prhs[2]) && !mxIsComplex(prhs[2])) {
+            dna_cof(prhs[2], dims, dnacof);
+        } else {
+            mexErrMsgTxt("DNA must be [], a COF [row col slice] or a real "
+                         "image the same size as LABELED.");
+        }
+        dna = dnacof;
+    }
+
+    W = mxGetData(prhs[1]);
+    switch (mxGetClassID(prhs[1])) {
+    case mxDOUBLE_CLASS:
+        dispatch_labels(prhs[0], (const double *) W, dims, scale, scaledist,
+                        dna, &stats, &cofs);
+        break;
+    case mxSINGLE_CLASS:
+        dispatch_labels(prhs[0], (const float *) W, dims, scale, scaledist,
+                        dna, &stats, &cofs);
+        break;
+    case mxUINT16_CLASS:
+        dispatch_labels(prhs[0], (const uint16_T *) W, dims, scale, scaledist,
+                        dna, &stats, &cofs);
+        break;
+    case mxUINT8_CLASS:
+        dispatch_labels(prhs[0], (const uint8_T *) W, dims, scale, scaledist,
+                        dna, &stats, &cofs);
+        break;
+    default:
+        mexErrMsgTxt("PROTIMG must be of class double, single, uint16 or "
+                     "uint8.");
+    }
+
+    plhs[0] = stats;
+    if (nlhs > 1)
+        plhs[1] = cofs;
+    else
+        mxDestroyArray(cofs);
+}
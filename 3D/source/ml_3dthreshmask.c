@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_3dthreshmask.c
+//
+//  Background subtraction, thresholding and binarization of a 3D image
+//  in two passes over the voxels.
+//
+//  [BINIMAGE, PROCIMAGE, THRESH, MOSTCOMMON] =
+//                      ml_3dthreshmask(IMAGE, METHOD, BGSUB, CROPIMAGE)
+//  where:
+//     -IMAGE is a 2D or 3D image of class uint8 or uint16
+//     -METHOD is 'nih' (ml_threshold, uint8 only, default) or 'rc'
+//      (ml_rcthreshold)
+//     -BGSUB (default true) subtracts the most common voxel value, as
+//      ml_3dbgsub does
+//     -CROPIMAGE (optional) is a logical or uint8 mask, of the size of
+//      IMAGE or of one slice of it; voxels where it is 0 are set to 0
+//      after the background subtraction, as ml_mask does
+//     -BINIMAGE is the uint8 0/1 image PROCIMAGE >= floor(THRESH), as
+//      ml_binarize returns it
+//     -PROCIMAGE is the background subtracted and cropped image
+//     -THRESH is the threshold as ml_3dpreprocess computes it,
+//      255*ml_threshold(PROCIMAGE) or ml_rcthreshold(PROCIMAGE)
+//     -MOSTCOMMON is the value that was subtracted
+//
+//  The first pass histograms IMAGE, over all voxels and over the
+//  cropped ones.  The histogram of PROCIMAGE is that of the cropped
+//  voxels shifted by MOSTCOMMON, so the threshold is found without
+//  building PROCIMAGE.  The second pass subtracts, crops and compares
+//  16 bytes at a time with SSE2 and writes BINIMAGE (and PROCIMAGE only
+//  when it is requested).  Both passes run in parallel with OpenMP.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* voxels per parallel block */
+#define BLOCK 65536
+
+/*
+ * Histograms HALL of all voxels and HIN of the voxels where CROP is
+ * nonzero.  CROP repeats every CROPN voxels.  PARTIAL holds two
+ * histograms per thread.
+ */
+static void threshmask_histograms(const unsigned char *Image8,
+                                  const unsigned short *Image16,
+                                  unsigned long n, const unsigned char *crop,
+                                  unsigned long cropn, unsigned long nbins,
+                                  int nthreads, unsigned long *partial,
+                                  unsigned long *hall, unsigned long *hin)
+{
+    long nblocks = (long) ((n + BLOCK - 1) / BLOCK);
+    unsigned long i;
+    int t;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        unsigned long *ha = partial, *hi;
+        long b;
+
+#ifdef _OPENMP
+        ha += 2 * nbins * omp_get_thread_num();
+#endif
+        hi = ha + nbins;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (b = 0; b < nblocks; b++) {
+            unsigned long p = (unsigned long) b * BLOCK;
+            unsigned long end = (p + BLOCK < n) ? p + BLOCK : n;
+            unsigned long c = crop ? p % cropn : 0;
+
+            for (; p < end; p++) {
+                unsigned int v = Image8 ? Image8[p] : Image16[p];
+
+                ha[v]++;
+                if (crop) {
+                    if (crop[c])
+                        hi[v]++;
+                    if (++c == cropn)
+                        c = 0;
+                }
+            }
+        }
+    }
+
+    for (t = 0; t < nthreads; t++) {
+        for (i = 0; i < nbins; i++) {
+            hall[i] += partial[2 * nbins * t + i];
+            hin[i] += partial[2 * nbins * t + nbins + i];
+        }
+    }
+}
+
+/*
+ * ml_rcthreshold on the histogram H of the values 0..NBINS-1.  The
+ * averages come from prefix sums; all the sums are integers, so they
+ * are the ones ml_rcthreshold computes.
+ */
+static double rc_threshold(const double *H, long nbins)
+{
+    double *C = (double *) mxCalloc(nbins, sizeof(double));
+    double *S = (double *) mxCalloc(nbins, sizeof(double));
+    long minidx = 0, maxidx = 0, moving, prev, k;
+
+    /* values 0 and nbins-1 are ignored */
+    for (k = 1; k < nbins; k++) {
+        double h = (k < nbins - 1) ? H[k] : 0.0;
+
+        C[k] = C[k - 1] + h;
+        S[k] = S[k - 1] + k * h;
+        if (h > 0) {
+            if (minidx == 0)
+                minidx = k;
+            maxidx = k;
+        }
+    }
+    if (minidx == 0)
+        minidx = maxidx = 1;
+
+    if (minidx >= maxidx) {
+        mexWarnMsgTxt("There is <= 1 nonzero pixel intensity");
+        mxFree(C);
+        mxFree(S);
+        return (double) minidx;
+    }
+
+    moving = minidx + 1;
+    prev = minidx;
+    while (prev != moving && moving < maxidx) {
+        double loweravg = (S[moving - 1] - S[minidx - 1]) /
+                          (C[moving - 1] - C[minidx - 1]);
+        double higheravg = (S[maxidx] - S[moving - 1]) /
+                           (C[maxidx] - C[moving - 1]);
+
+        prev = moving;
+        moving = (long) ceil((loweravg + higheravg) / 2);
+    }
+
+    mxFree(C);
+    mxFree(S);
+    return (double) moving;
+}
+
+/*
+ * 255*ml_threshold on the histogram H of the uint8 values.  ml_threshold
+ * works on the flipped histogram F(i) = H(256-i), i = 1..256.
+ */
+static double nih_threshold(const double *H)
+{
+    double F[257], C[257], S[257], result;
+    int minidx = 1, maxidx = 256, moving, i;
+
+    F[0] = C[0] = S[0] = 0.0;
+    for (i = 1; i <= 256; i++) {
+        F[i] = (i > 1 && i < 256) ? H[256 - i] : 0.0;
+        C[i] = C[i - 1] + F[i];
+        S[i] = S[i - 1] + i * F[i];
+    }
+
+    while (F[minidx] == 0 && minidx < 256)
+        minidx++;
+    while (F[maxidx] == 0 && maxidx > 1)
+        maxidx--;
+
+    if (minidx >= maxidx) {
+        mexPrintf("There is <= 1 nonzero pixel intensity\n");
+        result = 128;
+    } else {
+        result = maxidx;
+        for (moving = minidx; moving + 1 <= result && moving <= maxidx - 1;
+             moving++) {
+            result = ((S[moving] - S[minidx - 1]) / (C[moving] - C[minidx - 1]) +
+                      (S[maxidx] - S[moving]) / (C[maxidx] - C[moving])) / 2;
+        }
+    }
+
+    /* result >= 0, so this rounds halves up as MATLAB's round does */
+    return 255 * (1 - floor(result + 0.5) / 255);
+}
+
+/*
+ * Subtracts M, crops and thresholds LEN voxels; CROP (or NULL) is
+ * aligned with I, PROC may be NULL
+ */
+static void threshmask_run8(const unsigned char *I, const unsigned char *crop,
+                            unsigned long len, unsigned char m,
+                            unsigned char t, unsigned char *proc,
+                            unsigned char *bin)
+{
+    unsigned long i = 0;
+
+#ifdef __SSE2__
+    const __m128i vm = _mm_set1_epi8((char) m), vt = _mm_set1_epi8((char) t);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_subs_epu8(_mm_loadu_si128((const __m128i *) (I + i)), vm);
+
+        if (crop) {
+            __m128i c = _mm_loadu_si128((const __m128i *) (crop + i));
+            x = _mm_andnot_si128(_mm_cmpeq_epi8(c, zero), x);
+        }
+        if (proc)
+            _mm_storeu_si128((__m128i *) (proc + i), x);
+        /* x >= t  <=>  t -sat x == 0 */
+        x = _mm_cmpeq_epi8(_mm_subs_epu8(vt, x), zero);
+        _mm_storeu_si128((__m128i *) (bin + i), _mm_and_si128(x, one));
+    }
+#endif
+    for (; i < len; i++) {
+        unsigned char x = (I[i] > m) ? I[i] - m : 0;
+
+        if (crop && !crop[i])
+            x = 0;
+        if (proc)
+            proc[i] = x;
+        bin[i] = (x >= t);
+    }
+}
+
+static void threshmask_run16(const unsigned short *I, const unsigned char *crop,
+                             unsigned long len, unsigned short m,
+                             unsigned short t, unsigned short *proc,
+                             unsigned char *bin)
+{
+    unsigned long i = 0;
+
+#ifdef __SSE2__
+    const __m128i vm = _mm_set1_epi16((short) m), vt = _mm_set1_epi16((short) t);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1);
+
+    for (; i + 8 <= len; i += 8) {
+        __m128i x = _mm_subs_epu16(_mm_loadu_si128((const __m128i *) (I + i)), vm);
+
+        if (crop) {
+            __m128i c = _mm_loadl_epi64((const __m128i *) (crop + i));
+            c = _mm_unpacklo_epi8(c, zero);
+            x = _mm_andnot_si128(_mm_cmpeq_epi16(c, zero), x);
+        }
+        if (proc)
+            _mm_storeu_si128((__m128i *) (proc + i), x);
+        x = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(vt, x), zero), one);
+        _mm_storel_epi64((__m128i *) (bin + i), _mm_packus_epi16(x, x));
+    }
+#endif
+    for (; i < len; i++) {
+        unsigned short x = (I[i] > m) ? I[i] - m : 0;
+
+        if (crop && !crop[i])
+            x = 0;
+        if (proc)
+            proc[i] = x;
+        bin[i] = (x >= t);
+    }
+}
+
+/*
+ * Second pass, in parallel blocks; a block is split where CROP wraps
+ * around
+ */
+static void threshmask_binarize(const unsigned char *Image8,
+                                const unsigned short *Image16,
+                                unsigned long n, const unsigned char *crop,
+                                unsigned long cropn, unsigned int m,
+                                unsigned int t, void *proc,
+                                unsigned char *bin, int nthreads)
+{
+    long nblocks = (long) ((n + BLOCK - 1) / BLOCK);
+    long b;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (b = 0; b < nblocks; b++) {
+        unsigned long p = (unsigned long) b * BLOCK;
+        unsigned long end = (p + BLOCK < n) ? p + BLOCK : n;
+
+        while (p < end) {
+            unsigned long stop = end;
+            const unsigned char *c = NULL;
+
+            if (crop) {
+                c = crop + p % cropn;
+                if (p - p % cropn + cropn < stop)
+                    stop = p - p % cropn + cropn;
+            }
+            if (Image8) {
+                threshmask_run8(Image8 + p, c, stop - p, (unsigned char) m,
+                                (unsigned char) t,
+                                proc ? (unsigned char *) proc + p : NULL,
+                                bin + p);
+            } else {
+                threshmask_run16(Image16 + p, c, stop - p, (unsigned short) m,
+                                 (unsigned short) t,
+                                 proc ? (unsigned short *) proc + p : NULL,
+                                 bin + p);
+            }
+            p = stop;
+        }
+    }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const unsigned char *Image8 = NULL, *crop = NULL;
+    const unsigned short *Image16 = NULL;
+    unsigned long n, cropn = 0, nbins, i, *partial, *hall, *hin;
+    unsigned int mostcommon = 0, t;
+    const mwSize *dims;
+    mwSize ndims;
+    mxClassID classid;
+    double *H, thresh;
+    char method[4] = "nih";
+    int bgsub = 1, nthreads = 1;
+    void *proc = NULL;
+
+    if (nrhs < 1 || nrhs > 4) {
+        mexErrMsgTxt("[BINIMAGE, PROCIMAGE, THRESH, MOSTCOMMON] = "
+                     "ml_3dthreshmask(IMAGE, METHOD, BGSUB, CROPIMAGE), "
+                     "background subtraction and thresholding.");
+    } else if (nlhs > 4) {
+        mexErrMsgTxt("ml_3dthreshmask returns at most four outputs.");
+    }
+
+    classid = mxGetClassID(prhs[0]);
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if ((classid != mxUINT8_CLASS && classid != mxUINT16_CLASS) || ndims > 3) {
+        mexErrMsgTxt("IMAGE must be a 2D or 3D matrix of class uint8 or "
+                     "uint16.");
+    }
+    dims = mxGetDimensions(prhs[0]);
+    n = (unsigned long) mxGetNumberOfElements(prhs[0]);
+
+    if (nrhs > 1 && (!mxIsChar(prhs[1]) ||
+                     mxGetString(prhs[1], method, sizeof(method)) != 0 ||
+                     (strcmp(method, "nih") != 0 && strcmp(method, "rc") != 0))) {
+        mexErrMsgTxt("Unknown thresholding method");
+    }
+    if (strcmp(method, "nih") == 0 && classid != mxUINT8_CLASS) {
+        mexErrMsgTxt("The 'nih' threshold requires a uint8 IMAGE.");
+    }
+    if (nrhs > 2)
+        bgsub = (mxGetScalar(prhs[2]) != 0);
+    if (nrhs > 3 && !mxIsEmpty(prhs[3])) {
+        cropn = (unsigned long) mxGetNumberOfElements(prhs[3]);
+        if (!mxIsLogical(prhs[3]) && mxGetClassID(prhs[3]) != mxUINT8_CLASS) {
+            mexErrMsgTxt("CROPIMAGE must be of class logical or uint8.");
+        }
+        if (cropn != n && cropn != (unsigned long) (dims[0] * dims[1])) {
+            mexErrMsgTxt("CROPIMAGE must be the size of IMAGE or of one "
+                         "of its slices.");
+        }
+        crop = (const unsigned char *) mxGetData(prhs[3]);
+    }
+
+    if (classid == mxUINT8_CLASS) {
+        Image8 = (const unsigned char *) mxGetData(prhs[0]);
+        nbins = 256;
+    } else {
+        Image16 = (const unsigned short *) mxGetData(prhs[0]);
+        nbins = 65536;
+    }
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+    if (n < BLOCK)
+        nthreads = 1;
+#endif
+    /* the mx allocators must not be called by threads */
+    partial = (unsigned long *) mxCalloc(2 * nbins * nthreads,
+                                         sizeof(unsigned long));
+    hall = (unsigned long *) mxCalloc(2 * nbins, sizeof(unsigned long));
+    hin = hall + nbins;
+    threshmask_histograms(Image8, Image16, n, crop, cropn, nbins, nthreads,
+                          partial, hall, hin);
+    mxFree(partial);
+    if (crop == NULL)
+        hin = hall;
+
+    /* most common value, the lowest one on ties as with mode() */
+    if (bgsub) {
+        for (i = 1; i < nbins; i++) {
+            if (hall[i] > hall[mostcommon])
+                mostcommon = (unsigned int) i;
+        }
+    }
+
+    /* histogram of PROCIMAGE, but for the zeros which are ignored */
+    H = (double *) mxCalloc(nbins, sizeof(double));
+    for (i = 1; i + mostcommon < nbins; i++)
+        H[i] = (double) hin[i + mostcommon];
+    mxFree(hall);
+
+    if (strcmp(method, "nih") == 0)
+        thresh = nih_threshold(H);
+    else
+        thresh = rc_threshold(H, (long) nbins);
+    mxFree(H);
+
+    /* uint8(floor(thresh)) for uint8 images */
+    if (floor(thresh) <= 0)
+        t = 0;
+    else if (floor(thresh) >= (double) (nbins - 1))
+        t = (unsigned int) (nbins - 1);
+    else
+        t = (unsigned int) floor(thresh);
+
+    plhs[0] = mxCreateNumericArray(ndims, dims, mxUINT8_CLASS, mxREAL);
+    if (nlhs > 1) {
+        plhs[1] = mxCreateNumericArray(ndims, dims, classid, mxREAL);
+        proc = mxGetData(plhs[1]);
+    }
+    threshmask_binarize(Image8, Image16, n, crop, cropn, mostcommon, t, proc,
+                        (unsigned char *) mxGetData(plhs[0]), nthreads);
+
+    if (nlhs > 2)
+        plhs[2] = mxCreateDoubleScalar(thresh);
+    if (nlhs > 3)
+        plhs[3] = mxCreateDoubleScalar((double) mostcommon);
+}
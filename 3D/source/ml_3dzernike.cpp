@@ -0,0 +1,582 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                           ml_3dzernike.cpp
+//
+//  3D Zernike moments and rotation invariant descriptors of every
+//  object in a labeled volume.
+//
+//  [F, OMEGA] = ml_3dzernike(LABELED, IMAGE, N, R, SPACING)
+//  where:
+//     -LABELED is a 3D label volume (uint8, uint16, uint32, int32 or
+//      double); label 0 is background
+//     -IMAGE is a weight volume of the same size (uint8, uint16, single
+//      or double), or [] to weight every object voxel by 1 (shape only)
+//     -N is the maximum order of the moments
+//     -R is the radius of the unit ball in physical units; 0 or [] fits
+//      the ball to each object (its largest voxel distance from the
+//      center of mass), which makes the descriptors scale invariant
+//     -SPACING (optional) is the voxel size [row col slice]; default
+//      [1 1 1]
+//     -F is an nobjects x numDescriptors matrix of the descriptors
+//      F_nl = sqrt(sum over m=-l:l of |OMEGA_nl^m|^2), in the order
+//      for n=0:N, for l=0:n, if mod(n-l,2)==0 (as in ml_zernike)
+//     -OMEGA is an nobjects x numMoments complex matrix of the moments
+//      OMEGA_nl^m for m=0:l in the same (n,l) order (the m<0 moments
+//      follow from OMEGA_nl^-m = (-1)^m conj(OMEGA_nl^m))
+//
+//  Reference: M. Novotni and R. Klein, "3D Zernike descriptors for
+//  content based shape retrieval," Proc. ACM Symposium on Solid
+//  Modeling and Applications, 2003.
+//
+//  Each Zernike polynomial Z_nl^m is expanded once into a table of
+//  coefficients chi_nlm^rst over the monomials x^r y^s z^t, r+s+t <= n.
+//  Every object then needs only its geometric moments M_rst, and
+//  OMEGA_nl^m = 3/(4 pi) * sum of conj(chi_nlm^rst) M_rst / M_000.
+//  The voxels of each object are bucketed by label in two raster scans
+//  (no per-object volumes are created) and the objects are processed in
+//  parallel with OpenMP.
+//
+//  The expansion loses precision for high orders; N <= 20 is advised.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_ORDER 40
+
+typedef struct ChiTerm_tag
+{
+    int    monomial;  /* index into the geometric moment table */
+    double re;
+    double im;
+} ChiTerm_T;
+
+typedef struct ChiTable_tag
+{
+    int        order;
+    int        num_monomials;
+    int       *monomial_index;  /* (order+1)^3 map from (r,s,t) */
+    int        num_descriptors; /* number of (n,l) pairs */
+    int        num_moments;     /* number of (n,l,m) triples, m >= 0 */
+    int       *moment_start;    /* num_moments+1 offsets into terms */
+    int       *moment_nl;       /* (n,l) pair of each moment */
+    int       *moment_m;
+    ChiTerm_T *terms;
+} ChiTable_T;
+
+static double factorial(int n)
+{
+    double result = 1.0;
+
+    for (; n > 1; n--)
+        result *= n;
+    return result;
+}
+
+static double binomial(int n, int k)
+{
+    if (k < 0 || k > n)
+        return 0.0;
+    return factorial(n) / (factorial(k) * factorial(n - k));
+}
+
+//
+// Coefficient of r^(2*nu+l) in the radial polynomial R_nl, k=(n-l)/2
+//
+static double radial_coefficient(int k, int l, int nu)
+{
+    return ((k % 2) ? -1.0 : 1.0) / pow(2.0, 2.0 * k) *
+        sqrt((2.0 * l + 4.0 * k + 3.0) / 3.0) * binomial(2 * k, k) *
+        ((nu % 2) ? -1.0 : 1.0) * binomial(k, nu) *
+        binomial(2 * (k + l + nu) + 1, 2 * k) / binomial(k + l + nu, k);
+}
+
+static int monomial_at(const ChiTable_T *table, int r, int s, int t)
+{
+    int n1 = table->order + 1;
+    return table->monomial_index[(r * n1 + s) * n1 + t];
+}
+
+//
+// Expands Z_nl^m = R_nl(|x|) Y_l^m into monomials.  With
+//   r^l P_l^m(cos theta) e^(i m phi) = (-1)^m 2^-l sum_j (-1)^j C(l,j)
+//       C(2l-2j,l) (l-2j)!/(l-2j-m)! (x+iy)^m z^(l-2j-m) |x|^(2j)
+// and R_nl(|x|) = sum_nu q_nu |x|^(2 nu + l), every term is a power of
+// |x|^2 = x^2+y^2+z^2 times (x+iy)^m z^p, expanded multinomially into
+// the dense scratch polynomial poly_re/poly_im.
+//
+static void expand_zernike(const ChiTable_T *table, int n, int l, int m,
+                           double *poly_re, double *poly_im)
+{
+    int k = (n - l) / 2;
+    int nu, j, u, a, b, c, e;
+    double norm = sqrt((2.0 * l + 1.0) / (4.0 * M_PI) *
+                       factorial(l - m) / factorial(l + m));
+
+    memset(poly_re, 0, table->num_monomials * sizeof(double));
+    memset(poly_im, 0, table->num_monomials * sizeof(double));
+
+    for (nu = 0; nu <= k; nu++) {
+        double q = radial_coefficient(k, l, nu);
+        for (j = 0; 2 * j <= l - m; j++) {
+            double legendre = ((m % 2) ? -1.0 : 1.0) / pow(2.0, l) *
+                ((j % 2) ? -1.0 : 1.0) * binomial(l, j) *
+                binomial(2 * l - 2 * j, l) *
+                factorial(l - 2 * j) / factorial(l - 2 * j - m);
+            int p = l - 2 * j - m;
+            e = nu + j;
+            for (u = 0; u <= m; u++) {
+                /* (x + iy)^m term: C(m,u) x^(m-u) (iy)^u */
+                double w = norm * q * legendre * binomial(m, u);
+                double wr = 0.0, wi = 0.0;
+                switch (u % 4) {
+                case 0: wr = w; break;
+                case 1: wi = w; break;
+                case 2: wr = -w; break;
+                case 3: wi = -w; break;
+                }
+                for (a = 0; a <= e; a++) {
+                    for (b = 0; a + b <= e; b++) {
+                        c = e - a - b;
+                        double multinomial = factorial(e) /
+                            (factorial(a) * factorial(b) * factorial(c));
+                        int idx = monomial_at(table, m - u + 2 * a,
+                                              u + 2 * b, p + 2 * c);
+                        poly_re[idx] += multinomial * wr;
+                        poly_im[idx] += multinomial * wi;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void make_chi_table(int N, ChiTable_T *table)
+{
+    int n1 = N + 1;
+    int n, l, m, r, s, t, idx, count;
+
+    table->order = N;
+    table->monomial_index = (int *) mxMalloc(n1 * n1 * n1 * sizeof(int));
+    for (idx = 0, r = 0; r <= N; r++)
+        for (s = 0; s <= N; s++)
+            for (t = 0; t <= N; t++)
+                table->monomial_index[(r * n1 + s) * n1 + t] =
+                    (r + s + t <= N) ? idx++ : -1;
+    table->num_monomials = idx;
+
+    table->num_descriptors = 0;
+    table->num_moments = 0;
+    for (n = 0; n <= N; n++)
+        for (l = n % 2; l <= n; l += 2) {
+            table->num_descriptors++;
+            table->num_moments += l + 1;
+        }
+
+    table->moment_start = (int *) mxMalloc((table->num_moments + 1) * sizeof(int));
+    table->moment_nl = (int *) mxMalloc(table->num_moments * sizeof(int));
+    table->moment_m = (int *) mxMalloc(table->num_moments * sizeof(int));
+
+    double *poly_re = (double *) mxMalloc(table->num_monomials * sizeof(double));
+    double *poly_im = (double *) mxMalloc(table->num_monomials * sizeof(double));
+    int capacity = 1024;
+    table->terms = (ChiTerm_T *) mxMalloc(capacity * sizeof(ChiTerm_T));
+
+    count = 0;
+    idx = 0;
+    int nl = 0;
+    for (n = 0; n <= N; n++) {
+        for (l = n % 2; l <= n; l += 2, nl++) {
+            for (m = 0; m <= l; m++, idx++) {
+                table->moment_start[idx] = count;
+                table->moment_nl[idx] = nl;
+                table->moment_m[idx] = m;
+                expand_zernike(table, n, l, m, poly_re, poly_im);
+                for (r = 0; r < table->num_monomials; r++) {
+                    if (poly_re[r] == 0.0 && poly_im[r] == 0.0)
+                        continue;
+                    if (count == capacity) {
+                        capacity *= 2;
+                        table->terms = (ChiTerm_T *) mxRealloc(table->terms,
+                            capacity * sizeof(ChiTerm_T));
+                    }
+                    table->terms[count].monomial = r;
+                    table->terms[count].re = poly_re[r];
+                    table->terms[count].im = poly_im[r];
+                    count++;
+                }
+            }
+        }
+    }
+    table->moment_start[idx] = count;
+
+    mxFree(poly_re);
+    mxFree(poly_im);
+}
+
+static void destroy_chi_table(ChiTable_T *table)
+{
+    mxFree(table->monomial_index);
+    mxFree(table->moment_start);
+    mxFree(table->moment_nl);
+    mxFree(table->moment_m);
+    mxFree(table->terms);
+}
+
+template<typename L_T>
+static inline mwSize label_at(const L_T *L, mwSize p)
+{
+    double v = (double) L[p];
+    return (v >= 1.0) ? (mwSize) v : 0;
+}
+
+//
+// Buckets the voxel indices of every object in two raster scans.
+// Returns the number of objects (the largest label).
+//
+template<typename L_T>
+static mwSize bucket_voxels(const L_T *L, mwSize num_voxels,
+                            mwSize **start, mwSize **voxels)
+{
+    mwSize nobj = 0;
+    mwSize p, k;
+
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k > nobj)
+            nobj = k;
+    }
+
+    /* background voxels are not bucketed; first[1] == 0 */
+    mwSize *first = (mwSize *) mxCalloc(nobj + 2, sizeof(mwSize));
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k != 0)
+            first[k + 1]++;
+    }
+    for (k = 1; k <= nobj + 1; k++)
+        first[k] += first[k - 1];
+
+    mwSize *next = (mwSize *) mxMalloc((nobj + 1) * sizeof(mwSize));
+    mwSize *vox = (mwSize *) mxMalloc((first[nobj + 1] + 1) * sizeof(mwSize));
+    memcpy(next, first, (nobj + 1) * sizeof(mwSize));
+    for (p = 0; p < num_voxels; p++) {
+        k = label_at(L, p);
+        if (k != 0)
+            vox[next[k]++] = p;
+    }
+    mxFree(next);
+
+    *start = first;
+    *voxels = vox;
+    return nobj;
+}
+
+//
+// Geometric moments of one object, normalized into the unit ball
+//
+template<typename W_T>
+static void object_moments(const W_T *W, const mwSize *vox, mwSize nvox,
+                           const mwSize *dims, const double *spacing,
+                           double R, const ChiTable_T *table, double *M)
+{
+    int N = table->order;
+    double px[MAX_ORDER + 1], py[MAX_ORDER + 1], pz[MAX_ORDER + 1];
+    double m000 = 0.0, cx = 0.0, cy = 0.0, cz = 0.0, scale;
+    mwSize i;
+    int r, s, t, idx;
+
+    memset(M, 0, table->num_monomials * sizeof(double));
+
+    for (i = 0; i < nvox; i++) {
+        double w = W ? (double) W[vox[i]] : 1.0;
+        mwSize p = vox[i];
+        m000 += w;
+        cx += w * (double) (p % dims[0]) * spacing[0];
+        cy += w * (double) ((p / dims[0]) % dims[1]) * spacing[1];
+        cz += w * (double) (p / (dims[0] * dims[1])) * spacing[2];
+    }
+    if (m000 == 0.0)
+        return;
+    cx /= m000;
+    cy /= m000;
+    cz /= m000;
+
+    scale = R;
+    if (scale <= 0.0) {
+        for (i = 0; i < nvox; i++) {
+            mwSize p = vox[i];
+            double x, y, z, d;
+            if (W && W[p] == 0)
+                continue;
+            x = (double) (p % dims[0]) * spacing[0] - cx;
+            y = (double) ((p / dims[0]) % dims[1]) * spacing[1] - cy;
+            z = (double) (p / (dims[0] * dims[1])) * spacing[2] - cz;
+            d = sqrt(x * x + y * y + z * z);
+            if (d > scale)
+                scale = d;
+        }
+        if (scale == 0.0)
+            scale = 1.0;
+    }
+
+    for (i = 0; i < nvox; i++) {
+        mwSize p = vox[i];
+        double w = W ? (double) W[p] : 1.0;
+        double x, y, z;
+
+        if (w == 0.0)
+            continue;
+        x = ((double) (p % dims[0]) * spacing[0] - cx) / scale;
+        y = ((double) ((p / dims[0]) % dims[1]) * spacing[1] - cy) / scale;
+        z = ((double) (p / (dims[0] * dims[1])) * spacing[2] - cz) / scale;
+        if (x * x + y * y + z * z > 1.0)
+            continue;
+
+        px[0] = py[0] = 1.0;
+        pz[0] = w;
+        for (r = 1; r <= N; r++) {
+            px[r] = px[r - 1] * x;
+            py[r] = py[r - 1] * y;
+            pz[r] = pz[r - 1] * z;
+        }
+
+        /* monomials are numbered in (r,s,t) lexicographic order */
+        for (idx = 0, r = 0; r <= N; r++)
+            for (s = 0; r + s <= N; s++) {
+                double pxy = px[r] * py[s];
+                for (t = 0; r + s + t <= N; t++)
+                    M[idx++] += pxy * pz[t];
+            }
+    }
+
+    for (idx = 0; idx < table->num_monomials; idx++)
+        M[idx] /= m000;
+}
+
+template<typename L_T, typename W_T>
+static void compute_3dzernike(const L_T *L, const W_T *W, const mwSize *dims,
+                              const double *spacing, double R,
+                              const ChiTable_T *table, mxArray **F,
+                              mxArray **omega)
+{
+    mwSize num_voxels = dims[0] * dims[1] * dims[2];
+    mwSize *start, *voxels;
+    mwSize nobj = bucket_voxels(L, num_voxels, &start, &voxels);
+    long obj;
+
+    *F = mxCreateDoubleMatrix(nobj, table->num_descriptors, mxREAL);
+    *omega = mxCreateDoubleMatrix(nobj, table->num_moments, mxCOMPLEX);
+    double *f = mxGetPr(*F);
+    double *or_ = mxGetPr(*omega);
+    double *oi = mxGetPi(*omega);
+
+    /* per-thread moment buffers; the mx allocators are not thread safe */
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    double *moments = (double *) mxMalloc((mwSize) table->num_monomials *
+                                          nthreads * sizeof(double));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        double *M = moments;
+        int k, j;
+
+#ifdef _OPENMP
+        M += (mwSize) table->num_monomials * omp_get_thread_num();
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (obj = 0; obj < (long) nobj; obj++) {
+            object_moments(W, voxels + start[obj + 1],
+                           start[obj + 2] - start[obj + 1], dims, spacing, R,
+                           table, M);
+
+            for (k = 0; k < table->num_moments; k++) {
+                double sr = 0.0, si = 0.0;
+                for (j = table->moment_start[k]; j < table->moment_start[k + 1]; j++) {
+                    const ChiTerm_T *term = &table->terms[j];
+                    /* conj(chi) * M */
+                    sr += term->re * M[term->monomial];
+                    si -= term->im * M[term->monomial];
+                }
+                sr *= 3.0 / (4.0 * M_PI);
+                si *= 3.0 / (4.0 * M_PI);
+                or_[(mwSize) k * nobj + obj] = sr;
+                oi[(mwSize) k * nobj + obj] = si;
+                f[(mwSize) table->moment_nl[k] * nobj + obj] +=
+                    (table->moment_m[k] == 0 ? 1.0 : 2.0) * (sr * sr + si * si);
+            }
+            for (k = 0; k < table->num_descriptors; k++)
+                f[(mwSize) k * nobj + obj] = sqrt(f[(mwSize) k * nobj + obj]);
+        }
+    }
+
+    mxFree(moments);
+    mxFree(start);
+    mxFree(voxels);
+}
+
+template<typename W_T>
+static void dispatch_labels(const mxArray *labeled, const W_T *W,
+                            const mwSize *dims, const double *spacing,
+                            double R, const ChiTable_T *table,
+                            mxArray **F, mxArray **omega)
+{
+    void *L = mxGetData(labeled);
+
+    switch (mxGetClassID(labeled)) {
+    case mxDOUBLE_CLASS:
+        compute_3dzernike((const double *) L, W, dims, spacing, R, table, F, omega);
+        break;
+    case mxINT32_CLASS:
+        compute_3dzernike((const int32_T *) L, W, dims, spacing, R, table, F, omega);
+        break;
+    case mxUINT32_CLASS:
+        compute_3dzernike((const uint32_T *) L, W, dims, spacing, R, table, F, omega);
+        break;
+    case mxUINT16_CLASS:
+        compute_3dzernike((const uint16_T *) L, W, dims, spacing, R, table, F, omega);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_3dzernike((const uint8_T *) L, W, dims, spacing, R, table, F, omega);
+        break;
+    default:
+        mexErrMsgTxt("LABELED must be of class double, int32, uint32, uint16, "
+                     "uint8 or logical.");
+    }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mwSize dims[3];
+    double spacing[3] = {1.0, 1.0, 1.0};
+    double R = 0.0;
+    int N, k;
+    const mwSize *d;
+    mwSize nd;
+    ChiTable_T table;
+    mxArray *F = NULL, *omega = NULL;
+
+    if (nrhs < 3 || nrhs > 5) {
+        mexErrMsgTxt("[F, OMEGA] = ml_3dzernike(LABELED, IMAGE, N, R, SPACING), "
+                     "3D Zernike descriptors of every object in LABELED.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_3dzernike returns at most two outputs.");
+    }
+
+    nd = mxGetNumberOfDimensions(prhs[0]);
+    if (nd > 3) {
+        mexErrMsgTxt("LABELED must be a 3D volume.");
+    }
+    d = mxGetDimensions(prhs[0]);
+    dims[0] = d[0];
+    dims[1] = d[1];
+    dims[2] = (nd == 3) ? d[2] : 1;
+
+    if (!mxIsEmpty(prhs[1])) {
+        if (mxGetNumberOfElements(prhs[1]) != mxGetNumberOfElements(prhs[0]) ||
+            mxGetNumberOfDimensions(prhs[1]) != nd ||
+            memcmp(mxGetDimensions(prhs[1]), d, nd * sizeof(mwSize)) != 0) {
+            mexErrMsgTxt("IMAGE must be empty or the same size as LABELED.");
+        }
+        if (mxIsComplex(prhs[1])) {
+            mexErrMsgTxt("IMAGE must be real.");
+        }
+    }
+
+    if (mxGetNumberOfElements(prhs[2]) != 1 || mxGetScalar(prhs[2]) < 0 ||
+        mxGetScalar(prhs[2]) > MAX_ORDER) {
+        mexErrMsgTxt("N should be a scalar between 0 and 40.");
+    }
+    N = (int) mxGetScalar(prhs[2]);
+
+    if (nrhs > 3 && !mxIsEmpty(prhs[3])) {
+        R = mxGetScalar(prhs[3]);
+        if (R < 0.0)
+            mexErrMsgTxt("R should be nonnegative.");
+    }
+
+    if (nrhs > 4) {
+        if (!mxIsDouble(prhs[4]) || mxGetNumberOfElements(prhs[4]) != 3)
+            mexErrMsgTxt("SPACING should be a double vector [row col slice].");
+        for (k = 0; k < 3; k++)
+            spacing[k] = mxGetPr(prhs[4])[k];
+    }
+
+    make_chi_table(N, &table);
+
+    if (mxIsEmpty(prhs[1])) {
+        dispatch_labels(prhs[0], (const uint8_T *) NULL, dims, spacing, R,
+                        &table, &F, &omega);
+    } else {
+        void *W = mxGetData(prhs[1]);
+        switch (mxGetClassID(prhs[1])) {
+        case mxDOUBLE_CLASS:
+            dispatch_labels(prhs[0], (const double *) W, dims, spacing, R,
+                            &table, &F, &omega);
+            break;
+        case mxSINGLE_CLASS:
+            dispatch_labels(prhs[0], (const float *) W, dims, spacing, R,
+                            &table, &F, &omega);
+            break;
+        case mxUINT16_CLASS:
+            dispatch_labels(prhs[0], (const uint16_T *) W, dims, spacing, R,
+                            &table, &F, &omega);
+            break;
+        case mxUINT8_CLASS:
+        case mxLOGICAL_CLASS:
+            dispatch_labels(prhs[0], (const uint8_T *) W, dims, spacing, R,
+                            &table, &F, &omega);
+            break;
+        default:
+            destroy_chi_table(&table);
+            mexErrMsgTxt("IMAGE must be of class double, single, uint16, "
+                         "uint8 or logical.");
+        }
+    }
+
+    destroy_chi_table(&table);
+
+    plhs[0] = F;
+    if (nlhs > 1)
+        plhs[1] = omega;
+    else
+        mxDestroyArray(omega);
+}
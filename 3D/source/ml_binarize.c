@@ -22,6 +22,7 @@
 #ifdef _MEX_
 #include "mex.h"
 #include "matrix.h"
+#include "ml_bitmask.h"
 #endif /* #ifdef _MEX_ */
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,44 +34,83 @@
 #include <sys/resource.h>
 #include <unistd.h>
 #include <sys/types.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* output[i] = (Image[i] >= thresh), 16 voxels at a time with SSE2 */
+void binarize( unsigned char *Image, unsigned char *output,
+	       unsigned long length, unsigned char thresh)
+{
+  long nblocks = (long) ((length + 65535) / 65536);
+  long b;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(nblocks > 1)
+#endif
+  for( b = 0; b < nblocks; b++) {
+    unsigned long i = (unsigned long) b * 65536;
+    unsigned long end = i + 65536 < length ? i + 65536 : length;
+#ifdef __SSE2__
+    const __m128i vt = _mm_set1_epi8( (char) thresh);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8( 1);
+
+    /* x >= thresh  <=>  thresh -sat x == 0 */
+    for( ; i + 16 <= end; i += 16) {
+      __m128i x = _mm_loadu_si128( (const __m128i*) (Image + i));
+      x = _mm_cmpeq_epi8( _mm_subs_epu8( vt, x), zero);
+      _mm_storeu_si128( (__m128i*) (output + i), _mm_and_si128( x, one));
+    }
+#endif
+    for( ; i < end; i++)
+      output[i] = (Image[i] >= thresh);
+  }
+}
 
 #ifdef _MEX_
+/* OUTIMG = ml_binarize(IMAGE, THRESH) is the uint8 image IMAGE >= THRESH;
+ * ml_binarize(IMAGE, THRESH, 'packed') returns it bit-packed in a uint64
+ * column vector, see ml_bitmask.h */
 void mexFunction(
 		 int nlhs,
 		 mxArray *plhs[], 
 		 int nrhs,
 		 const mxArray *prhs[])
 {
-  unsigned char* output ;     /* Return value to Matlab */
-
-    int x, y, z, i;
-    long n_voxels; /* The total number of voxels in the image */
+    unsigned long n_voxels; /* The total number of voxels in the image */
 
     unsigned char *Image;
-    long NDims;
-    const int *Dims;
-    int Width, Height, Depth;
+    mwSize NDims;
+    const mwSize *Dims;
 
-    unsigned char MostCommonPixelValue;
-    int newvalue;
     unsigned char *threshp;
     unsigned char thresh;
-    
+    char mode[8];
+    int packed = 0;
 
     /* Argument checking */
-    if (nrhs != 2) {
-      mexErrMsgTxt("ml_binarize() requires two input arguments.") ;
-    } else if (nlhs != 1) {
+    if (nrhs != 2 && nrhs != 3) {
+      mexErrMsgTxt("ml_binarize() requires two or three input arguments.") ;
+    } else if (nlhs > 1) {
       mexErrMsgTxt("ml_binarize() returns a single output.") ;
     }
 
+    if (!mxIsUint8( prhs[0]))
+      mexErrMsgTxt("IMAGE argument must be of class uint8") ;
+    if (nrhs == 3) {
+      if (!mxIsChar( prhs[2]) || mxGetString( prhs[2], mode, sizeof(mode)) != 0
+	  || strcmp( mode, "packed") != 0)
+	mexErrMsgTxt("The third argument to ml_binarize() must be 'packed'") ;
+      packed = 1;
+    }
+
     /* Get Image size info etc */
     NDims = mxGetNumberOfDimensions( prhs[0]);
     Dims = mxGetDimensions( prhs[0]);
-    n_voxels = 1;
-    for( i = 0; i < NDims; i++) {
-      n_voxels = n_voxels * Dims[i]; 
-    }
+    n_voxels = (unsigned long) mxGetNumberOfElements( prhs[0]);
 
     /* Get hold of the input image */
     Image = (unsigned char*) mxGetData( prhs[0]);
@@ -82,17 +122,14 @@ void mexFunction(
     thresh = *threshp;
     /*printf("Thresh = %i",thresh); */
 
-    /* Create output image */
-    plhs[0] = mxCreateNumericArray(NDims, Dims, mxUINT8_CLASS, mxREAL) ;
-    output = (unsigned char*) mxGetData(plhs[0]) ;
-
     /*////////////////////////////////////////////////////////////////*/
-    for( i = 0; i < n_voxels; i++) {
-      if( Image[i] >= thresh) {
-	output[i] = 1;
-      } else {
-	output[i] = 0;
-      }
+    if( packed) {
+      plhs[0] = mxCreateNumericMatrix( BITMASK_WORDS(n_voxels), 1,
+				       mxUINT64_CLASS, mxREAL);
+      bitmask_pack( Image, n_voxels, thresh, (uint64_T*) mxGetData(plhs[0]));
+    } else {
+      plhs[0] = mxCreateNumericArray(NDims, Dims, mxUINT8_CLASS, mxREAL) ;
+      binarize( Image, (unsigned char*) mxGetData(plhs[0]), n_voxels, thresh);
     }
     /*////////////////////////////////////////////////////////////////*/
 
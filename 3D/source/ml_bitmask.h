@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_bitmask.h
+//
+//  Bit-packed binary masks, shared by ml_binarize, ml_unpackmask and
+//  ml_maskcount.  Voxel k of a mask is bit k%64 of the uint64 word
+//  k/64, least significant bit first; the unused bits of the last word
+//  are 0.  A mask of N voxels takes BITMASK_WORDS(N) words, 8 times
+//  less memory than a uint8 or logical volume.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#ifndef ML_BITMASK_H
+#define ML_BITMASK_H
+
+#include "mex.h"
+#include "matrix.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BITMASK_WORDS(n) (((n) + 63) / 64)
+
+/* static inline, so unused functions do not warn; __inline also works
+   under the -ansi of older mex setups */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#define BITMASK_INLINE static inline
+#else
+#define BITMASK_INLINE static __inline
+#endif
+
+/*
+ * WORDS = (IMAGE >= T) for N uint8 voxels.  Full words are built 16
+ * voxels at a time with an SSE2 compare and movemask.
+ */
+BITMASK_INLINE void bitmask_pack(const unsigned char *Image,
+                                  unsigned long n, unsigned char t,
+                                  uint64_T *words)
+{
+    long nfull = (long) (n / 64), w;
+    unsigned long k;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(nfull > 4096)
+#endif
+    for (w = 0; w < nfull; w++) {
+        const unsigned char *I = Image + 64 * (unsigned long) w;
+        uint64_T bits = 0;
+        int j;
+
+#ifdef __SSE2__
+        const __m128i vt = _mm_set1_epi8((char) t), zero = _mm_setzero_si128();
+
+        /* x >= t  <=>  t -sat x == 0 */
+        for (j = 0; j < 4; j++) {
+            __m128i x = _mm_loadu_si128((const __m128i *) (I + 16 * j));
+            __m128i ge = _mm_cmpeq_epi8(_mm_subs_epu8(vt, x), zero);
+
+            bits |= (uint64_T) (unsigned int) _mm_movemask_epi8(ge) << (16 * j);
+        }
+#else
+        for (j = 0; j < 64; j++)
+            bits |= (uint64_T) (I[j] >= t) << j;
+#endif
+        words[w] = bits;
+    }
+
+    if (n % 64) {
+        uint64_T bits = 0;
+
+        for (k = 64 * (unsigned long) nfull; k < n; k++)
+            bits |= (uint64_T) (Image[k] >= t) << (k % 64);
+        words[nfull] = bits;
+    }
+}
+
+/*
+ * Number of bits set in NWORDS words
+ */
+BITMASK_INLINE double bitmask_count(const uint64_T *words,
+                                    unsigned long nwords)
+{
+    double count = 0.0;
+    long w;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:count) if(nwords > 65536)
+#endif
+    for (w = 0; w < (long) nwords; w++) {
+#ifdef __GNUC__
+        count += __builtin_popcountll(words[w]);
+#else
+        uint64_T x = words[w];
+        int c = 0;
+
+        while (x) {
+            x &= x - 1;
+            c++;
+        }
+        count += c;
+#endif
+    }
+    return count;
+}
+
+/*
+ * MASK(k) = bit k of WORDS for N voxels.  Each byte of a word expands
+ * to 8 logicals through a 256-entry table.
+ */
+BITMASK_INLINE void bitmask_unpack(const uint64_T *words, unsigned long n,
+                                    mxLogical *mask)
+{
+    mxLogical table[256][8];
+    long nfull = (long) (n / 64), w;
+    unsigned long k;
+    int b, j;
+
+    for (b = 0; b < 256; b++)
+        for (j = 0; j < 8; j++)
+            table[b][j] = (mxLogical) ((b >> j) & 1);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(nfull > 4096)
+#endif
+    for (w = 0; w < nfull; w++) {
+        uint64_T bits = words[w];
+        mxLogical *M = mask + 64 * (unsigned long) w;
+        int i;
+
+        for (i = 0; i < 8; i++)
+            memcpy(M + 8 * i, table[(bits >> (8 * i)) & 0xff],
+                   8 * sizeof(mxLogical));
+    }
+
+    for (k = 64 * (unsigned long) nfull; k < n; k++)
+        mask[k] = (mxLogical) ((words[k / 64] >> (k % 64)) & 1);
+}
+
+#endif /* ML_BITMASK_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_maskcount.c
+//
+//  Number of true voxels of a bit-packed mask, as ml_binarize(IMAGE,
+//  THRESH, 'packed') returns it, without unpacking it.
+//
+//  COUNT = ml_maskcount(PACKED)
+//  where:
+//     -PACKED is a uint64 vector, see ml_bitmask.h
+//     -COUNT is the number of bits set in PACKED
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include "ml_bitmask.h"
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 1) {
+        mexErrMsgTxt("COUNT = ml_maskcount(PACKED), number of true voxels of "
+                     "a bit-packed mask.");
+    } else if (nlhs > 1) {
+        mexErrMsgTxt("ml_maskcount returns a single output.");
+    }
+
+    if (mxGetClassID(prhs[0]) != mxUINT64_CLASS) {
+        mexErrMsgTxt("PACKED must be of class uint64.");
+    }
+
+    plhs[0] = mxCreateDoubleScalar(
+        bitmask_count((const uint64_T *) mxGetData(prhs[0]),
+                      (unsigned long) mxGetNumberOfElements(prhs[0])));
+}
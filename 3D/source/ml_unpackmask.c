@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_unpackmask.c
+//
+//  Expands a bit-packed mask, as ml_binarize(IMAGE, THRESH, 'packed')
+//  returns it, to a logical array.
+//
+//  [MASK, COUNT] = ml_unpackmask(PACKED, DIMS)
+//  where:
+//     -PACKED is a uint64 vector, see ml_bitmask.h
+//     -DIMS is the size of the mask, size(IMAGE)
+//     -MASK is the logical array of size DIMS
+//     -COUNT (optional) is the number of true voxels, nnz(MASK)
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include "ml_bitmask.h"
+
+#define MAX_DIMS 32
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mwSize dims[MAX_DIMS], ndims, k;
+    unsigned long n = 1, nwords;
+    const double *D;
+
+    if (nrhs != 2) {
+        mexErrMsgTxt("[MASK, COUNT] = ml_unpackmask(PACKED, DIMS), unpacks "
+                     "a bit-packed mask.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_unpackmask returns at most two outputs.");
+    }
+
+    if (mxGetClassID(prhs[0]) != mxUINT64_CLASS) {
+        mexErrMsgTxt("PACKED must be of class uint64.");
+    }
+    ndims = (mwSize) mxGetNumberOfElements(prhs[1]);
+    if (!mxIsDouble(prhs[1]) || ndims < 2 || ndims > MAX_DIMS) {
+        mexErrMsgTxt("DIMS must be a size vector with at least 2 elements.");
+    }
+
+    D = mxGetPr(prhs[1]);
+    for (k = 0; k < ndims; k++) {
+        if (D[k] < 0 || D[k] != (double) (mwSize) D[k]) {
+            mexErrMsgTxt("DIMS must contain nonnegative integers.");
+        }
+        dims[k] = (mwSize) D[k];
+        n *= (unsigned long) dims[k];
+    }
+
+    nwords = (unsigned long) mxGetNumberOfElements(prhs[0]);
+    if (nwords != BITMASK_WORDS(n)) {
+        mexErrMsgTxt("PACKED does not hold prod(DIMS) voxels.");
+    }
+
+    plhs[0] = mxCreateLogicalArray(ndims, dims);
+    bitmask_unpack((const uint64_T *) mxGetData(prhs[0]), n,
+                   mxGetLogicals(plhs[0]));
+    if (nlhs > 1) {
+        plhs[1] = mxCreateDoubleScalar(
+            bitmask_count((const uint64_T *) mxGetData(prhs[0]), nwords));
+    }
+}
@@ -0,0 +1,104 @@
+function times = ml_moments_1_benchmark(imgsize, nreps, oldfcn)
+% TIMES = ML_MOMENTS_1_BENCHMARK(IMGSIZE, NREPS, OLDFCN) times ML_MOMENTS_1
+% ML_MOMENTS_1_BENCHMARK(IMGSIZE, NREPS, OLDFCN),
+%     Times the ML_MOMENTS_1 MEX file on a synthetic IMGSIZE x IMGSIZE
+%     int32 image (default 2048) with a grid of 64x64 pixel objects,
+%     averaged over NREPS calls (default 10), with and without the
+%     NUM_OBJECTS argument, and checks the result against an ACCUMARRAY
+%     reference.  OLDFCN (optional) is a handle to another build to
+%     compare against, e.g. the previous version compiled as
+%     ml_moments_1_old; it is called with (IMAGE, LABELED) only.
+%
+%     TIMES holds the mean seconds per call: [reference, new without
+%     NUM_OBJECTS, new with NUM_OBJECTS, OLDFCN (NaN if not given)].
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
+
+if nargin < 1 || isempty(imgsize)
+    imgsize = 2048;
+end
+if nargin < 2 || isempty(nreps)
+    nreps = 10;
+end
+if nargin < 3
+    oldfcn = [];
+end
+
+%
+% Synthetic image: a grid of 64x64 objects with 20% background holes
+%
+rand('state',0);
+[Y,X] = ndgrid(1:imgsize,1:imgsize);
+ncols = ceil(imgsize/64);
+labeled = int32((floor((Y-1)/64)*ncols + floor((X-1)/64) + 1) .* ...
+                (rand(imgsize) > 0.2));
+image = int32(floor(rand(imgsize)*4096));
+num_objects = double(max(labeled(:)));
+
+times = repmat(NaN,1,4);
+
+%
+% Reference
+%
+tic;
+for i = 1:nreps
+    idx = double(labeled(:))+1;
+    values = double(image(:));
+    ref = [accumarray(idx,values)'; accumarray(idx,values.*X(:))'; ...
+           accumarray(idx,values.*Y(:))'; accumarray(idx,1)'];
+end
+times(1) = toc/nreps;
+
+tic;
+for i = 1:nreps
+    [a,b,c,d] = ml_moments_1(image,labeled);
+end
+times(2) = toc/nreps;
+
+tic;
+for i = 1:nreps
+    [a,b,c,d] = ml_moments_1(image,labeled,num_objects);
+end
+times(3) = toc/nreps;
+
+if max(max(abs([a;b;c;d]-ref))) ~= 0
+    error('ml_moments_1 does not match the reference');
+end
+
+if ~isempty(oldfcn)
+    tic;
+    for i = 1:nreps
+        [a,b,c,d] = oldfcn(image,labeled);
+    end
+    times(4) = toc/nreps;
+    fprintf('old version max abs difference: %g\n', ...
+            max(max(abs([a;b;c;d]-ref))));
+end
+
+fprintf('%dx%d image, %d objects, %d repetitions\n', ...
+        imgsize, imgsize, num_objects, nreps);
+fprintf('  accumarray reference      %8.2f ms\n', 1000*times(1));
+fprintf('  ml_moments_1              %8.2f ms\n', 1000*times(2));
+fprintf('  ml_moments_1, NUM_OBJECTS %8.2f ms\n', 1000*times(3));
+if ~isempty(oldfcn)
+    fprintf('  %-25s %8.2f ms\n', func2str(oldfcn), 1000*times(4));
+end
@@ -17,16 +17,24 @@
 %   ml_imgskelfeats - calculate skelenton features
 %   ml_objskelfeats  -   Calculate skeleton features for the object OBJIMG.
 %   ml_mmthin - rewrite the mmthin function in the morphological toolbox
+%   ml_thin - bit-packed hit-or-miss thinning used by ml_mmthin (MEX)
 %   ml_find_branch_points - find the branch points of the skeleton
+%   ml_skelgraph - nodes, edges and lengths of the skeleton of every object (MEX)
 % Zernike Moment Features
 %   ml_zernike     - Calculate Zernike Moment Features
+%   ml_objzernike  - Zernike moments of every object in a labeled image (MEX)
+%   ml_zernikecache - Zernike moments of fixed-size crops from a cached basis (MEX)
 %   ml_imgmoments  - calculates the moment MXY for IMAGE
 % Wavelet Features
 %   ml_wavefeatures - Calculate Wavelet Features
 % Garbor Features
 %   ml_gaborfeat - calculate Garbor features
+% Threshold Adjacency Statistics
+%   ml_tas - calculate TAS features of a 2D or 3D image
+%   ml_tasstats - TAS and nTAS histograms in a single pass (MEX)
 % Others:
 %   ml_imgcentmoments - calculates the central moment MUxy for IMAGE
+%   ml_objmoments  - Raw and central moments up to order 4 of every object (MEX)
 
 % Copyright (C) 2006  Murphy Lab
 % Carnegie Mellon University
@@ -0,0 +1,43 @@
+function [M, MU, COUNT] = ml_objmoments(I,L)
+% [M, MU, COUNT] = ML_OBJMOMENTS(I,L) moments of every object in L
+% ML_OBJMOMENTS(I,L),
+%     Returns the raw moments M and the central moments MU up to order 4
+%     of each object of the labeled image L, one row per label
+%     (N = max(L(:))), and the number of pixels COUNT of each label.
+%     The columns hold, for p+q = 0..4,
+%        [m00 m10 m01 m20 m11 m02 m30 m21 m12 m03 m40 m31 m22 m13 m04]
+%     i.e. m_pq is in column (p+q)*(p+q+1)/2 + q + 1.  M(K,c) equals
+%     ML_IMGMOMENTS(I.*(L==K),p,q) and MU(K,c) equals
+%     ML_IMGCENTMOMENTS(I.*(L==K),p,q); x is the column and y the row.
+%     Objects with m00 == 0 get NaN central moments.
+%
+%     If L is omitted or empty the whole image is a single object, so
+%     ML_OBJMOMENTS(I) replaces repeated calls to ML_IMGMOMENTS and
+%     ML_IMGCENTMOMENTS on the same image.
+%
+%     I may be uint8, uint16, int32, single, double or logical.  L may
+%     be double, int32, uint32, uint16, uint8 or logical; label 0 is
+%     background.  The image is scanned once.
+%
+%     See also ML_IMGMOMENTS, ML_IMGCENTMOMENTS, ML_3DOBJMOMENTS
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,42 @@
+function Z = ml_objzernike(I,L,D,R)
+% Z = ML_OBJZERNIKE(I,L,D,R) Zernike moments of every object in L
+% ML_OBJZERNIKE(I,L,D,R),
+%     Returns an N x numMoments complex matrix of the Zernike moments
+%     through degree D of each object of the labeled image L, where
+%     N = max(L(:)).  Row K holds the same values, in the same order, as
+%     the ZVALUES returned by ML_ZERNIKE(I.*(L==K),D,R): the pixel
+%     coordinates are centered on the center of fluorescence of the
+%     object and normalized by the maximum radius R.
+%
+%     I may be uint8, uint16, int32, single or double.  L (for example
+%     the output of BWLABEL) may be double, int32, uint32, uint16 or
+%     uint8; label 0 is background.
+%
+%     The image is scanned once to count and once to bucket the pixels
+%     of each object; the moments are then computed in parallel over
+%     objects when the MEX file is compiled with OpenMP.
+%
+%     For use as features, take the magnitude (abs(Z)).
+%
+%     See also ML_ZERNIKE, ML_ZNL
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
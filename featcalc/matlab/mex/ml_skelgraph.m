@@ -0,0 +1,46 @@
+function [STATS, NODES, EDGES] = ml_skelgraph(SKEL,L)
+% [STATS, NODES, EDGES] = ML_SKELGRAPH(SKEL,L) graph of the skeleton of every object
+% ML_SKELGRAPH(SKEL,L),
+%     Builds the graph of the skeleton SKEL (e.g. from ML_THIN) of each
+%     object of the labeled image L (label 0 is ignored; if L is omitted
+%     the whole skeleton is one object).  Pixels are connected by
+%     m-adjacency (diagonal neighbors only when they share no 4-neighbor
+%     in the skeleton); end points and clusters of junction pixels are
+%     the nodes and the paths between them the edges.
+%
+%     STATS has one row per object:
+%        [pixels endpoints junctions edges length branchpoints]
+%     where length is the total edge length (sqrt(2) per diagonal step)
+%     and branchpoints is the number of pixels with 3 or more
+%     4-neighbors, as counted by ML_FIND_BRANCH_POINTS.
+%
+%     NODES is [label row col type degree], type 1 for end points,
+%     2 for junctions and 0 for isolated pixels and closed loops.
+%     EDGES is [label node1 node2 length pixels], node1 and node2 being
+%     rows of NODES and pixels the number of interior pixels.
+%
+%     Objects are processed in parallel when the MEX file is compiled
+%     with OpenMP.
+%
+%     See also ML_THIN, ML_OBJSKELFEATS, ML_FIND_BRANCH_POINTS
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,37 @@
+function VALUES = ml_tasstats(IMAGE,LOW,HIGH)
+% VALUES = ML_TASSTATS(IMAGE,LOW,HIGH) threshold adjacency statistics
+% ML_TASSTATS(IMAGE,LOW,HIGH),
+%     Computes the TAS and nTAS histograms of the binary image
+%     B = (IMAGE > LOW) & (IMAGE < HIGH) in a single pass.  VALUES is
+%     [TAS NTAS]: TAS(n+1) is the fraction of the pixels of B that have
+%     n background neighbors and NTAS(n+1) the fraction of the
+%     background pixels that have n neighbors in B.  Only pixels whose
+%     neighborhood lies entirely inside the image are counted.
+%
+%     For a 2D image the 8-neighborhood is used (9 + 9 values), for a
+%     3D image the 26-neighborhood (27 + 27 values).  IMAGE may be
+%     uint8, uint16, int32, single or double.  3D images are processed
+%     in parallel over slices when the MEX file is compiled with OpenMP.
+%
+%     See also ML_TAS
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -0,0 +1,41 @@
+function SKEL = ml_thin(BW,MODE)
+% SKEL = ML_THIN(BW,MODE) thinning of a binary image
+% ML_THIN(BW,MODE),
+%     Returns the logical skeleton of BW (nonzero pixels are foreground)
+%     obtained by removing, in turn, the hits of the eight structuring
+%     elements of ML_MMTHIN until a full round of the eight removes no
+%     pixel.  SKEL equals ML_MMTHIN(BW).
+%
+%     The image is bit-packed, 64 pixels per word, and all pixels of a
+%     word are matched against an element with bitwise operations;
+%     words are processed in parallel when the MEX file is compiled
+%     with OpenMP.
+%
+%     MODE is 'frontier' (default) or 'sweep'.  'sweep' evaluates the
+%     whole image in every pass.  'frontier' only revisits the words
+%     next to pixels removed during the last round of eight passes, so
+%     each pass costs time proportional to the object boundary rather
+%     than the image.  Both modes return the same skeleton.
+%
+%     See also ML_MMTHIN, ML_OBJSKELFEATS
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
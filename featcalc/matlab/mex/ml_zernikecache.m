@@ -0,0 +1,43 @@
+function Z = ml_zernikecache(I,D,R,CENTER)
+% Z = ML_ZERNIKECACHE(I,D,R,CENTER) Zernike moments from a cached basis
+% ML_ZERNIKECACHE(I,D,R),
+% ML_ZERNIKECACHE(I,D,R,CENTER),
+%     Returns a NIMAGES x numMoments complex matrix of the Zernike
+%     moments through degree D of each crop in the ROWS x COLS x NIMAGES
+%     stack I, in the same order as ML_ZERNIKE.  R is the maximum radius
+%     (in pixels) and CENTER = [ROW COL] is the origin of the Zernike
+%     polynomials (default: the center of the grid).
+%
+%     The sampled polynomials depend only on (R, D, grid size, CENTER),
+%     so they are computed on the first call and kept in memory as single
+%     precision arrays; every image then reduces to one matrix-vector
+%     product.  The result equals ML_ZERNIKE(I(:,:,K),D,R) when the
+%     center of fluorescence of the crop is CENTER, e.g. for cells
+%     cropped to a fixed radius around their center.
+%
+%     ML_ZERNIKECACHE('clear') frees the cached bases.
+%
+%     I may be uint8, uint16, single or double.
+%
+%     See also ML_ZERNIKE, ML_OBJZERNIKE
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
@@ -34,10 +34,11 @@ hullshape = (Phull^2)/(4*pi*Ahull) ;
 %
 % Central moments of the convex hull
 %
-hull_mu00 = ml_imgcentmoments(imagehull,0,0) ;
-hull_mu11 = ml_imgcentmoments(imagehull,1,1) ;
-hull_mu02 = ml_imgcentmoments(imagehull,0,2) ;
-hull_mu20 = ml_imgcentmoments(imagehull,2,0) ;
+[hull_m, hull_mu] = ml_objmoments(imagehull) ;
+hull_mu00 = hull_mu(1) ;
+hull_mu11 = hull_mu(5) ;
+hull_mu02 = hull_mu(6) ;
+hull_mu20 = hull_mu(4) ;
 
 %
 % Parameters of the 'image ellipse'
@@ -79,21 +79,18 @@ values = [values obj_number features.EulerNumber] ;
 
 %
 % Calculate the center of fluorescence of IMAGE
+%    (ml_objmoments returns [m00 m10 m01 ...] from a single pass)
 %
-imageproc_m00 = ml_imgmoments(imageproc,0,0) ;
-imageproc_m01 = ml_imgmoments(imageproc,0,1) ;
-imageproc_m10 = ml_imgmoments(imageproc,1,0) ;
-imageproc_center = [imageproc_m10/imageproc_m00 imageproc_m01/imageproc_m00] ;
+imageproc_m = ml_objmoments(imageproc) ;
+imageproc_center = [imageproc_m(2)/imageproc_m(1) imageproc_m(3)/imageproc_m(1)] ;
 
 % 
 % Calculate DNA COF, if necessary
 %
 if ~isempty(dnaproc)
-	dnaproc_m00 = ml_imgmoments(dnaproc,0,0) ;
-	dnaproc_m01 = ml_imgmoments(dnaproc,0,1) ;
-	dnaproc_m10 = ml_imgmoments(dnaproc,1,0) ;
-	dnaproc_center = [dnaproc_m10/dnaproc_m00 ...
-                          dnaproc_m01/dnaproc_m00] ;
+	dnaproc_m = ml_objmoments(dnaproc) ;
+	dnaproc_center = [dnaproc_m(2)/dnaproc_m(1) ...
+                          dnaproc_m(3)/dnaproc_m(1)] ;
 end
 
 %
@@ -118,7 +115,7 @@ obj_dnadistances = [] ;
 % out below; the C version runs approx. 100X faster (10,000%)
 %
 [img_moment00, img_moment10, img_moment01, obj_size] = ml_moments_1(int32(imageproc),... 
-								     int32(imagelabeled));
+								     int32(imagelabeled), obj_number);
 
 obj_sizes = obj_size(1,2:end);
 % /GP
@@ -8,6 +8,8 @@ function [names, values, slfnames] = ml_imgskelfeats(imageproc )
 %
 % Created by MV 1/18/02
 % Modified MV 6/2/02: Added SLF names
+% Modified 10/18/26: all objects thinned and analyzed at once with
+%   ml_thin and ml_skelgraph
 
 % Copyright (C) 2006  Murphy Lab
 % Carnegie Mellon University
@@ -35,19 +37,57 @@ function [names, values, slfnames] = ml_imgskelfeats(imageproc )
 % values of the features.
 values = [] ;
 
+names = {'obj_skel_len' ...
+        'obj_skel_hull_area_ratio' ...
+        'obj_skel_obj_area_ratio' ...
+        'obj_skel_obj_fluor_ratio' ...
+        'obj_skel_branch_per_len'};
+
 % Find objects in the image
 %
-imagelabeled = bwlabel(im2bw(imageproc)) ;
+imagebin = im2bw(imageproc) ;
+imagelabeled = bwlabel(imagebin) ;
 obj_number = max(imagelabeled(:)) ;
 
-% For each object ...
-for (i=1:obj_number)
-    % Get an image of the single object
-    objmask = (imagelabeled==i) ;
-    objimage = imageproc .* objmask ;
-    % Compute skeleton features
-    [skelfeats, names] = ml_objskelfeats( objimage);
-    values = [values; skelfeats];
+if (obj_number > 0)
+    % The objects are 8-connected components, so no pixel of one object
+    % is in the 3x3 neighborhood of another: thinning the whole image
+    % gives the same skeletons as ml_objskelfeats does object by object
+    imageskel = ml_thin(imagebin) ;
+    skelstats = ml_skelgraph(imageskel, imagelabeled) ;
+    skellen = skelstats(:,1) ;
+    no_of_branch_points = skelstats(:,6) ;
+
+    % Object and skeleton sizes and fluorescence
+    objidx = find(imagelabeled) ;
+    objlabels = imagelabeled(objidx) ;
+    objsize = accumarray(objlabels, 1, [obj_number 1]) ;
+    obj_fluor = accumarray(objlabels, double(imageproc(objidx)), [obj_number 1]) ;
+    skelidx = find(imageskel) ;
+    skellabels = imagelabeled(skelidx) ;
+    skel_fluor = accumarray(skellabels, double(imageproc(skelidx)), [obj_number 1]) ;
+
+    % Convex hull of each skeleton, on the bounding box of its pixels
+    [skelrows, skelcols] = ind2sub(size(imageproc), skelidx) ;
+    [skellabels, order] = sort(skellabels) ;
+    skelrows = skelrows(order) ;
+    skelcols = skelcols(order) ;
+    last = cumsum(skellen) ;
+    first = last - skellen + 1 ;
+    hullsize = zeros(obj_number, 1) ;
+    for (i=1:obj_number)
+        r = skelrows(first(i):last(i)) - min(skelrows(first(i):last(i))) + 1 ;
+        c = skelcols(first(i):last(i)) - min(skelcols(first(i):last(i))) + 1 ;
+        objskel = zeros(max(r), max(c)) ;
+        objskel(sub2ind(size(objskel), r, c)) = 1 ;
+        hullsize(i) = length(find(ml_imgconvhull(objskel))) ;
+    end
+    % if hull size comes out smaller than length of skeleton then it
+    % is obviously wrong, therefore adjust
+    hullsize = max(hullsize, skellen) ;
+
+    values = [skellen skellen./hullsize skellen./objsize ...
+              skel_fluor./obj_fluor no_of_branch_points./skellen] ;
 end
 
 % Average the skeleton features over the whole cell
@@ -6,6 +6,7 @@ function img_skel = ml_mmthin(bin_image)
 % rewrite the mmthin function in the morphological toolbox
 % This code is written by yenixsa and Sam in Summer 2004
 % Last updated on 12/3/2005
+% 18-Oct-2026 thinning moved to the ml_thin MEX file
 
 % Copyright (C) 2006  Murphy Lab
 % Carnegie Mellon University
@@ -28,49 +29,11 @@ function img_skel = ml_mmthin(bin_image)
 % For additional information visit http://murphylab.web.cmu.edu or
 % send email to murphy@cmu.edu
 
-degrees = 45;
-num_elem = abs(360/degrees);
+% The hit-or-miss loop over the eight structuring elements
+%   [0 0 0; 2 1 2; 1 1 1] and its rotations by 45 degrees
+% (0 background, 1 foreground, 2 don't care) runs in the ml_thin MEX
+% file, which keeps the image bit-packed, only revisits pixels next to
+% the ones removed in the last round, and iterates until a full round
+% of the eight elements removes no pixel.
 
-struct_elem{1} = [0 0 0; 2 1 2; 1 1 1];
-struct_elem{2} = [2 0 0; 1 1 0; 1 1 2];
-struct_elem{3} = [1 2 0; 1 1 0; 1 2 0];
-struct_elem{4} = [1 1 2; 1 1 0; 2 0 0];
-struct_elem{5} = [1 1 1; 2 1 2; 0 0 0];
-struct_elem{6} = [2 1 1; 0 1 1; 0 0 2];
-struct_elem{7} = [0 2 1; 0 1 1; 0 2 1];
-struct_elem{8} = [0 0 2; 0 1 1; 2 1 1];
-
-[r, c] = size(bin_image);
-
-total_oper = 0;
-acnum_elem = 0;
-keep_num = 0;
-
-bin_image = double(bin_image);
-
-while 1
-   acnum_elem = acnum_elem + 1;
-   
-   image_exp = zeros(r+4, c+4);
-   image_exp(3:r+2, 3:c+2) = bin_image;
-  
-   [changed_image, oper] = ml_hitmiss(struct_elem{acnum_elem}, image_exp);
-
-   total_oper = total_oper + oper;
-   keep_num = acnum_elem;
-    
-    if(acnum_elem == num_elem)
-       acnum_elem = 0;        
-    end
-     
-    bin_image = bin_image - changed_image;
-    
-    if(acnum_elem == 0)
-	if total_oper == 0
-	    break;
-        end
-	total_oper = 0;
-    end
-end
-
-img_skel = bin_image;
+img_skel = double(ml_thin(bin_image));
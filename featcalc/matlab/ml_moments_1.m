@@ -1,4 +1,4 @@
-function [a,b,c,d] = ml_moments_1(image,labeled)
+function [a,b,c,d] = ml_moments_1(image,labeled,num_objects)
 %ML_MOMENTS_1 Calculates the moments of the image. This method is an
 
 %adaptation of ml_moments.c.
@@ -9,7 +9,9 @@ function [a,b,c,d] = ml_moments_1(image,labeled)
 
 %        labeled, labeled object image, 2D matrix
 
-% output: a, moment00
+%        num_objects (optional), number of objects; default max(labeled(:))
+
+% output: a, moment00 of labels 0..num_objects
 
 %         b, moment10(X)
 
@@ -73,31 +75,31 @@ end
 if ~strcmp(class(labeled),'int32')
     error('Input LABELLED IMAGE must be of class int32')
 end
+if any(size(image)~=size(labeled))
+    error('IMAGE and LABELLED IMAGE must have the same size')
+end
+if any(labeled(:)<0)
+    error('LABELLED IMAGE must not contain negative labels')
+end
+
+if nargin < 3
+    num_objects = double(max([0; labeled(:)]));
+end
+moment_length = num_objects+1;
+
+[a,b,c,d] = calc_moments(image,labeled,moment_length);
+
 
+function [a,b,c,d] = calc_moments(image,labeled,num_objs)
+%Helper method that calculates the moments of every label 0..num_objs-1
 [yrows,xcols] = size(image);
-moment_length = number_of_objects(labeled);
-
-[a,b,c,d] = calc_moments(image,labels,xcols,yrows,moment_length);
-
-
-function l = number_of_objects(label)
-%Helper methods that returns the number of objects
-l = max(label)+1;
-l = l(1,1);
-
-function [a,b,c,d] = calc_moments(image,labels,xcols,yrows,num_objs)
-%Helper method that calculates the moments of the image
-a = zeros(1,num_objs);
-b = zeros(1,num_objs);
-c = zeros(1,num_objs);
-d = zeros(1,num_objs);
-
-for i = 1 : xcols
-    for j = 1 : yrows
-        moment_index = labels(j,i);
-        a(moment_index) = a(moment_index) + image(j,i);
-        b(moment_index) = b(moment_index) + image(j,i)*(i+1);
-        c(moment_index) = c(moment_index) + image(j,i)*(j+1);
-        d(moment_index) = d(moment_index) + 1;
-    end
+[Y,X] = ndgrid(1:yrows,1:xcols);
+idx = double(labeled(:))+1;
+if any(idx>num_objs)
+    error('LABELLED IMAGE contains labels outside 0..NUM_OBJECTS')
 end
+values = double(image(:));
+a = accumarray(idx,values,[num_objs 1])';
+b = accumarray(idx,values.*X(:),[num_objs 1])';
+c = accumarray(idx,values.*Y(:),[num_objs 1])';
+d = accumarray(idx,1,[num_objs 1])';
@@ -51,8 +51,9 @@ skel_hull_area_ratio = skellen / hullsize;
 skel_fluor = sum(objimg(find(objskel)));
 obj_fluor = sum(objimg(:));
 skel_obj_fluor_ratio = skel_fluor/obj_fluor;
-branch_points = ml_find_branch_points(double(objskel));
-no_of_branch_points = length(find(branch_points));
+% pixels with 3 or more 4-neighbors, as in ml_find_branch_points
+skelstats = ml_skelgraph(objskel);
+no_of_branch_points = skelstats(6);
 feats = [skellen skel_hull_area_ratio skel_obj_area_ratio ...
         skel_obj_fluor_ratio no_of_branch_points/skellen];
     
@@ -1,6 +1,6 @@
-function [names, values, slfnames] = ml_tas(img)
+function [names, values, slfnames] = ml_tas(img,original)
 % ML_TAS --- Calculate Threshold Adjacency Statistics
-% [NAMES, VALUES, SLFNAMES] = ML_TAS(IMAGE);
+% [NAMES, VALUES, SLFNAMES] = ML_TAS(IMAGE,ORIGINAL);
 %
 %  This algorithm was presented by Hamilton et al.
 % in "Fast automated cell phenotype image classification"
@@ -13,7 +13,13 @@ function [names, values, slfnames] = ml_tas(img)
 %
 %  To obtain the original version of the features, define a global variable
 % USE_ORIGINAL_TAS_PARAMETERS and set it to anything which evaluates as true.
-% 
+% ORIGINAL (optional) overrides the global variable: 1 for the original
+% parameters, 0 for the parameter free version.
+%
+%  If IMAGE is a 3D image the statistics are calculated over the
+% 26-neighborhood of each voxel and there are 27 TAS and 27 nTAS values.
+%
+%  The histograms are computed by the MEX function ML_TASSTATS.
 %
 % Copyright (C) 2007  Murphy Lab
 % Carnegie Mellon University
@@ -38,8 +44,12 @@ function [names, values, slfnames] = ml_tas(img)
 
 global USE_ORIGINAL_TAS_PARAMETERS;
 
+if ~exist('original','var')
+    original = USE_ORIGINAL_TAS_PARAMETERS;
+end
+
 pixels = uint16(img(:));
-if USE_ORIGINAL_TAS_PARAMETERS,
+if original,
     pixels(pixels <= 30) = [];
 else,
     pixels(pixels == 0)=[];
@@ -47,7 +57,7 @@ end
 
 mu = mean(pixels);
 
-if USE_ORIGINAL_TAS_PARAMETERS,
+if original,
     Margin=30;
 else,
     Margin=std(pixels);
@@ -56,10 +66,19 @@ end
 %disp(['mu: ' num2str(mu)])
 %disp(['margin: ' num2str(Margin_Top)])
 
-bimg=(img > mu - Margin) .* (img < mu + Margin);
+values = ml_tasstats(img, mu - Margin, mu + Margin);
 
-values=calculatetas(1.-bimg);
-values=[values calculatetas(bimg)];
+if ndims(img) == 3
+    names = {};
+    for k = 0 : 26
+        names = [names cellstr(sprintf('tas3d_%i', k))];
+    end
+    for k = 0 : 26
+        names = [names cellstr(sprintf('ntas3d_%i', k))];
+    end
+    slfnames = names;
+    return
+end
 
 names = {'tas_0', 'tas_1', 'tas_2', 'tas_3', 'tas_4', 'tas_5', 'tas_6', 'tas_7', 'tas_8', ...
     'ntas_0', 'tas_1', 'tas_2', 'tas_3', 'tas_4', 'tas_5', 'tas_6', 'tas_7', 'tas_8' };
@@ -67,14 +86,4 @@ slfnames = {'tas_0', 'tas_1', 'tas_2', 'tas_3', 'tas_4', 'tas_5', 'tas_6', 'tas_
     'ntas_0', 'tas_1', 'tas_2', 'tas_3', 'tas_4', 'tas_5', 'tas_6', 'tas_7', 'tas_8' };
 end
 
-function [values] = calculatetas(bimg),
-M=[1 1 1; 1 10 1; 1 1 1];
-V=conv2(double(bimg),double(M),'valid');
-V=V(:);
-V(V > 9)=[];
-values=histc(V,(1:9)-1);
-values=values'/sum(values);
-
-end
-
 % vim: set ts=4 sts=4 expandtab smartindent:
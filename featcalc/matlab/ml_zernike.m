@@ -50,8 +50,9 @@ zvalues = [] ;
 % Normalize the coordinates to the center of mass and normalize
 %  pixel distances using the maximum radius argument (R)
 %
-Xn = (X-ml_imgmoments(I,1,0)/ml_imgmoments(I,0,0))/R ;
-Yn = (Y-ml_imgmoments(I,0,1)/ml_imgmoments(I,0,0))/R ;
+M = ml_objmoments(I) ;
+Xn = (X-M(2)/M(1))/R ;
+Yn = (Y-M(3)/M(1))/R ;
 
 %
 % Find all pixels of distance <= 1.0 to center
@@ -31,7 +31,13 @@ else
 end
 
 !mex -DPI%M_PI ml_Znl.cpp
-mex ml_moments_1.c
+mex CXXFLAGS='$CXXFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' ml_objzernike.cpp
+mex CXXFLAGS='$CXXFLAGS -fopenmp -O3' LDFLAGS='$LDFLAGS -fopenmp' ml_zernikecache.cpp
+mex ml_objmoments.cpp
+mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' ml_moments_1.c
+mex CFLAGS='$CFLAGS -fopenmp -O3' LDFLAGS='$LDFLAGS -fopenmp' ml_thin.c
+mex CXXFLAGS='$CXXFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' ml_skelgraph.cpp
+mex CXXFLAGS='$CXXFLAGS -fopenmp -O3' LDFLAGS='$LDFLAGS -fopenmp' ml_tasstats.cpp
 
 if ispc
     !move *.mex* ..\matlab\mex
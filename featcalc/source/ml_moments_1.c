@@ -26,58 +26,96 @@
 //  moments for one object per call (requires an image containing 1 object only
 //
 //  [M00, M10, M01, OBJS] = gp_moments_1(IMAGE, LABELLED_IMAGE)
+//  [M00, M10, M01, OBJS] = gp_moments_1(IMAGE, LABELLED_IMAGE, NUM_OBJECTS)
 //  where:
-//     -M00, M10, M01 are 1xnum_of_objects matrices containing moments for each
-//      object
-//     -OBJS is a 1xnum_of_objects matrix containing the size of each object
-//     -IMAGE is an image of type UINT8 containing N objects
+//     -M00, M10, M01 are 1x(num_of_objects+1) matrices containing moments for
+//      each label 0..num_of_objects (label 0 is the background)
+//     -OBJS is a 1x(num_of_objects+1) matrix containing the size of each object
+//     -IMAGE is an image of type INT32 containing N objects
 //     -LABELLED_IMAGE is a matrix with size==IMAGE, of type INT32, generated
 //      by BWLABEL(IMAGE) after binarization of IMAGE
+//     -NUM_OBJECTS (optional) is the number of objects, e.g. the second
+//      output of BWLABEL; if omitted it is max(LABELLED_IMAGE(:))
 //
 //   08-Aug-01  G. Porreca
+//   18-Oct-26  Initialize the label count (it was read uninitialized), take
+//              it from the caller when known, reject labels outside
+//              0..NUM_OBJECTS, accumulate in 64-bit integers and run over
+//              columns in parallel with per-thread sums merged at the end
 //
 */
 
 #include "mex.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* per-label sums; 64-bit so that large images cannot overflow */
+typedef struct {
+  int64_T m00;
+  int64_T m10;
+  int64_T m01;
+  int64_T size;
+} moment_sums;
+
+static int number_of_objects(const int *label, mwSize npixels, int *num_objs);
+static int calc_Moments(const int *img, const int *labl, mwSize xcols,
+                        mwSize yrows, int num_objs, double *a, double *b,
+                        double *c, double *d);
 
 void mexFunction(int nlhs,               /* number of pointers to return args */
 		 mxArray *plhs[],        /* vector of pointers to return args */
 		 int nrhs,               /* number of pointers to input  args */
 		 const mxArray *prhs[]){ /* vector of pointers to input  args */
 
-  int *image;          /* original image */
-  int *labeled;        /* labeled object image */
+  const int *image;    /* original image */
+  const int *labeled;  /* labeled object image */
 
   double *a;            /* moment00 */
   double *b;            /* moment10 (X) */
   double *c;            /* moment01 (Y) */
   double *d;            /* object sizes */
 
-  int f, index, yrows, xcols, moment_length ;
-  
+  mwSize yrows, xcols;
+  int moment_length, i;
 
+  if (nrhs < 2 || nrhs > 3)
+    mexErrMsgTxt("[M00, M10, M01, OBJS] = ml_moments_1(IMAGE, LABELLED_IMAGE, NUM_OBJECTS)");
+  if (nlhs > 4)
+    mexErrMsgTxt("ml_moments_1 returns at most four outputs");
 
   /* perform type checking on input matrices */
-  if( !mxIsInt32( prhs[0])) 
+  if( !mxIsInt32( prhs[0]) || mxIsComplex( prhs[0])) 
     mexErrMsgTxt("Input IMAGE must be of class int32");
-  image = (int*) mxGetData( prhs[0]);
+  image = (const int*) mxGetData( prhs[0]);
 
-  if( !mxIsInt32( prhs[1])) 
+  if( !mxIsInt32( prhs[1]) || mxIsComplex( prhs[1])) 
     mexErrMsgTxt("Input LABELLED IMAGE must be of class int32");
-  labeled = (int*) mxGetData( prhs[1]);
+  labeled = (const int*) mxGetData( prhs[1]);
   
   /* size of input image (and labeled image) */
   yrows = mxGetM(prhs[0]);
   xcols = mxGetN(prhs[0]);
-
-  /* size of output moment matrices (num_of_objects) */
-  moment_length = number_of_objects(labeled, xcols, yrows);
+  if (mxGetM(prhs[1]) != yrows || mxGetN(prhs[1]) != xcols)
+    mexErrMsgTxt("IMAGE and LABELLED IMAGE must have the same size");
+
+  /* size of output moment matrices (num_of_objects + 1) */
+  if (nrhs == 3) {
+    double n;
+
+    if (mxGetNumberOfElements(prhs[2]) != 1)
+      mexErrMsgTxt("NUM_OBJECTS must be a scalar");
+    n = mxGetScalar(prhs[2]);
+    if (n < 0 || n != (double) (int) n)
+      mexErrMsgTxt("NUM_OBJECTS must be a nonnegative integer");
+    moment_length = (int) n + 1;
+  } else if (number_of_objects(labeled, yrows * xcols, &moment_length) != 0) {
+    mexErrMsgTxt("LABELLED IMAGE must not contain negative labels");
+  }
 
   /* assign mxArrays to output arguments */
-  plhs[0] = mxCreateDoubleMatrix(1,moment_length, mxREAL);
-  plhs[1] = mxCreateDoubleMatrix(1,moment_length, mxREAL);
-  plhs[2] = mxCreateDoubleMatrix(1,moment_length, mxREAL);
-  plhs[3] = mxCreateDoubleMatrix(1,moment_length, mxREAL);
+  for (i = 0; i < 4; i++)
+    plhs[i] = mxCreateDoubleMatrix(1, moment_length, mxREAL);
   
   /* get C pointers to output arguments */
   a = mxGetPr(plhs[0]);
@@ -86,7 +124,8 @@ void mexFunction(int nlhs,               /* number of pointers to return args */
   d = mxGetPr(plhs[3]);
   
   /* calculate moments and object sizes */
-  f = calc_Moments(image, labeled, xcols, yrows, moment_length, a, b, c, d);
+  if (calc_Moments(image, labeled, xcols, yrows, moment_length, a, b, c, d) != 0)
+    mexErrMsgTxt("LABELLED IMAGE contains labels outside 0..NUM_OBJECTS");
 } 
 
 
@@ -95,89 +134,107 @@ void mexFunction(int nlhs,               /* number of pointers to return args */
 
 /* determine the number of objects in the labeled image; i.e. the object */ 
 /* with the highest number + 1 (object[0:N-1], num_of_objs[1:N]) */
-int number_of_objects(int *label,     /* labeled object image */
-		      int xcols,      /* number of columns in image */
-		      int yrows){     /* number of rows in image */
-
-  int i, j, index=0, high;
-
-
-  for(i = 0; i < xcols; i++){
-    for(j = 0; j < yrows; j++){
-
-      if( *(label + index) > high){
-	high = *(label + index);
-      }
-
-      index++;
-    } 
-  } 
-
-  return high + 1;
-} 
-
-/* calculate the moments for each object in the image in one pass */
-int calc_Moments(int *img,            /* original image */
-		 int *labl,           /* labeled object image */
-		 int xcols,           /* number of columns in img */
-		 int yrows,           /* number of rows in img */
-		 int num_objs,        /* number of objects (1:N) in img */
-		 double *a,           /* moment00 */
-		 double *b,           /* moment10 (X) */
-		 double *c,           /* moment01 (Y) */
-		 double *d){          /* object sizes */
-
-  int i, index=0, j, moment_index;
-
-  /* return arrays will be incremented below; initialize them */
-  for(i = 0; i < num_objs; i++){
-    *(a + i) = 0;                     
-    *(b + i) = 0;                     
-    *(c + i) = 0;                     
-    *(d + i) = 0;                      
+/* returns nonzero if a label is negative */
+static int number_of_objects(const int *label,  /* labeled object image */
+                             mwSize npixels,    /* number of pixels in image */
+                             int *num_objs){    /* highest label + 1 */
+
+  long index;
+  int high = 0, low = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(max:high) reduction(min:low)
+#endif
+  for (index = 0; index < (long) npixels; index++) {
+    if (label[index] > high)
+      high = label[index];
+    if (label[index] < low)
+      low = label[index];
   }
 
-
-  /* iterate on the number of pixels */
-  for(i = 0; i < xcols; i++){
-    for(j = 0; j < yrows; j++){
-
-      index = (i * yrows) + j;
-      moment_index = *(labl + index);
-
-      /* sum of fluorescence for the current object */
-      *(a + moment_index) = *(a + moment_index) + *(img + index);
-
-      /* X-weighted sum of fluorescence (i) for the current object */
-      *(b + moment_index) = *(b + moment_index) + (*(img + index) * (i+1));
-
-      /* (Y-weighted sum of fluorescence (j) for the current object */
-      *(c + moment_index) = *(c + moment_index) + (*(img + index) * (j+1));
-
-      /* increment the number of pixels (size) for the current object */
-      *(d + moment_index) = *(d + moment_index) + 1;
-
-    } 
-  } 
-
-  return 0;
+  *num_objs = high + 1;
+  return low < 0;
 } 
-						         
-
-
-
-
-
- 
-
-
-
-
-
-
-
 
+/* calculate the moments for each object in the image in one pass; */
+/* each thread sums a block of columns into its own table and the tables */
+/* are merged at the end; returns nonzero if a label is out of range */
+static int calc_Moments(const int *img,   /* original image */
+                        const int *labl,  /* labeled object image */
+                        mwSize xcols,     /* number of columns in img */
+                        mwSize yrows,     /* number of rows in img */
+                        int num_objs,     /* number of labels (0:N) in img */
+                        double *a,        /* moment00 */
+                        double *b,        /* moment10 (X) */
+                        double *c,        /* moment01 (Y) */
+                        double *d){       /* object sizes */
+
+  moment_sums *total, *sums;
+  long i;
+  int k, nthreads = 1, bad = 0;
+
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+  /* one table per thread; table 0 receives the merged sums */
+  sums = (moment_sums *) mxCalloc((mwSize) nthreads * num_objs,
+                                  sizeof(moment_sums));
+  total = sums;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:bad) num_threads(nthreads)
+#endif
+  {
+    moment_sums *mine = sums;
+    mwSize j;
+
+#ifdef _OPENMP
+    mine = sums + (mwSize) omp_get_thread_num() * num_objs;
+#pragma omp for schedule(static)
+#endif
+    for (i = 0; i < (long) xcols; i++) {
+      const int *col_img = img + (mwSize) i * yrows;
+      const int *col_labl = labl + (mwSize) i * yrows;
+      int64_T x = i + 1;
+
+      for (j = 0; j < yrows; j++) {
+        int moment_index = col_labl[j];
+        int64_T value = col_img[j];
+        moment_sums *s;
+
+        if (moment_index < 0 || moment_index >= num_objs) {
+          bad++;
+          continue;
+        }
+        s = &mine[moment_index];
+
+        /* sum of fluorescence, X- and Y-weighted sums, and size */
+        s->m00 += value;
+        s->m10 += value * x;
+        s->m01 += value * (int64_T) (j + 1);
+        s->size++;
+      }
+    }
+  }
 
+  for (i = 1; i < nthreads; i++) {
+    const moment_sums *other = sums + (mwSize) i * num_objs;
 
+    for (k = 0; k < num_objs; k++) {
+      total[k].m00 += other[k].m00;
+      total[k].m10 += other[k].m10;
+      total[k].m01 += other[k].m01;
+      total[k].size += other[k].size;
+    }
+  }
 
+  for (k = 0; k < num_objs; k++) {
+    a[k] = (double) total[k].m00;
+    b[k] = (double) total[k].m10;
+    c[k] = (double) total[k].m01;
+    d[k] = (double) total[k].size;
+  }
 
+  mxFree(sums);
+  return bad;
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_objmoments.cpp
+//
+//  Raw and central moments up to order 4 of every object in an image,
+//  in one pass; replacement for repeated calls to ml_imgmoments and
+//  ml_imgcentmoments.
+//
+//  [M, MU, COUNT] = ml_objmoments(IMAGE, LABELED)
+//  where:
+//     -IMAGE is a 2D image (uint8, uint16, int32, single, double or
+//      logical)
+//     -LABELED (optional) is a label matrix with size==IMAGE (double,
+//      int32, uint32, uint16, uint8 or logical); label 0 is background.
+//      If omitted or [], the whole image is one object.
+//     -M is an N x 15 matrix of raw moments, N = max(LABELED(:)),
+//      M(k,:) = [m00 m10 m01 m20 m11 m02 m30 m21 m12 m03
+//                m40 m31 m22 m13 m04]
+//      i.e. m_pq is in column (p+q)*(p+q+1)/2 + q + 1.  As in
+//      ml_imgmoments, x is the (1-based) column and y the row.
+//     -MU is an N x 15 matrix of the central moments mu_pq about the
+//      center of fluorescence (m10/m00, m01/m00), in the same order.
+//      Objects with m00 == 0 get NaN central moments.
+//     -COUNT is an N x 1 vector with the number of pixels of each label
+//
+//  Sums are accumulated about the first pixel of each object, which
+//  keeps the powers small, and shifted to the image origin and to the
+//  center of fluorescence at the end.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+
+#define MAX_MOMENT_ORDER 4
+#define NUM_MOMENTS 15
+
+/* column of m_pq */
+#define MOMENT_INDEX(p, q) (((p) + (q)) * ((p) + (q) + 1) / 2 + (q))
+
+typedef struct ObjectMoments_tag
+{
+    double ref_x;              /* origin of the sums */
+    double ref_y;
+    bool   has_ref;
+    double sum[NUM_MOMENTS];   /* moments about (ref_x, ref_y) */
+    double count;
+} ObjectMoments_T;
+
+static const double binomial[MAX_MOMENT_ORDER + 1][MAX_MOMENT_ORDER + 1] = {
+    {1, 0, 0, 0, 0},
+    {1, 1, 0, 0, 0},
+    {1, 2, 1, 0, 0},
+    {1, 3, 3, 1, 0},
+    {1, 4, 6, 4, 1}
+};
+
+//
+// Moments about (ax, ay) from the sums about the object's reference
+//
+static void shift_moments(const ObjectMoments_T *obj, double ax, double ay,
+                          double *out)
+{
+    double dx[MAX_MOMENT_ORDER + 1], dy[MAX_MOMENT_ORDER + 1];
+    int p, q, i, j;
+
+    dx[0] = dy[0] = 1.0;
+    for (i = 1; i <= MAX_MOMENT_ORDER; i++) {
+        dx[i] = dx[i - 1] * (obj->ref_x - ax);
+        dy[i] = dy[i - 1] * (obj->ref_y - ay);
+    }
+
+    for (p = 0; p <= MAX_MOMENT_ORDER; p++) {
+        for (q = 0; p + q <= MAX_MOMENT_ORDER; q++) {
+            double value = 0.0;
+            for (i = 0; i <= p; i++)
+                for (j = 0; j <= q; j++)
+                    value += binomial[p][i] * binomial[q][j] *
+                        dx[p - i] * dy[q - j] * obj->sum[MOMENT_INDEX(i, j)];
+            out[MOMENT_INDEX(p, q)] = value;
+        }
+    }
+}
+
+template<typename L_T>
+static inline mwSize label_at(const L_T *L, mwSize p)
+{
+    double v;
+
+    if (L == NULL)
+        return 1;
+    v = (double) L[p];
+    return (v >= 1.0) ? (mwSize) v : 0;
+}
+
+template<typename I_T, typename L_T>
+static void accumulate_moments(const I_T *I, const L_T *L, mwSize rows,
+                               mwSize cols, ObjectMoments_T *objects)
+{
+    double px[MAX_MOMENT_ORDER + 1], py[MAX_MOMENT_ORDER + 1];
+    mwSize r, c, p = 0;
+    int i, j;
+
+    for (c = 0; c < cols; c++) {
+        for (r = 0; r < rows; r++, p++) {
+            mwSize k = label_at(L, p);
+            ObjectMoments_T *obj;
+            double w;
+
+            if (k == 0)
+                continue;
+            obj = &objects[k];
+            obj->count++;
+            if (!obj->has_ref) {
+                obj->ref_x = (double) (c + 1);
+                obj->ref_y = (double) (r + 1);
+                obj->has_ref = true;
+            }
+
+            w = (double) I[p];
+            if (w == 0.0)
+                continue;
+
+            px[0] = w;
+            py[0] = 1.0;
+            for (i = 1; i <= MAX_MOMENT_ORDER; i++) {
+                px[i] = px[i - 1] * ((double) (c + 1) - obj->ref_x);
+                py[i] = py[i - 1] * ((double) (r + 1) - obj->ref_y);
+            }
+            for (i = 0; i <= MAX_MOMENT_ORDER; i++)
+                for (j = 0; i + j <= MAX_MOMENT_ORDER; j++)
+                    obj->sum[MOMENT_INDEX(i, j)] += px[i] * py[j];
+        }
+    }
+}
+
+template<typename L_T>
+static mwSize max_label(const L_T *L, mwSize N)
+{
+    mwSize nobj = 0, p, k;
+
+    if (L == NULL)
+        return 1;
+    for (p = 0; p < N; p++) {
+        k = label_at(L, p);
+        if (k > nobj)
+            nobj = k;
+    }
+    return nobj;
+}
+
+template<typename I_T, typename L_T>
+static void compute_objmoments(const I_T *I, const L_T *L, mwSize rows,
+                               mwSize cols, mxArray *plhs[])
+{
+    mwSize nobj = max_label(L, rows * cols);
+    ObjectMoments_T *objects =
+        (ObjectMoments_T *) mxCalloc(nobj + 1, sizeof(ObjectMoments_T));
+    double raw[NUM_MOMENTS], central[NUM_MOMENTS];
+    mwSize k;
+    int j;
+
+    accumulate_moments(I, L, rows, cols, objects);
+
+    plhs[0] = mxCreateDoubleMatrix(nobj, NUM_MOMENTS, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(nobj, NUM_MOMENTS, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(nobj, 1, mxREAL);
+    double *M = mxGetPr(plhs[0]);
+    double *MU = mxGetPr(plhs[1]);
+    double *count = mxGetPr(plhs[2]);
+
+    for (k = 1; k <= nobj; k++) {
+        ObjectMoments_T *obj = &objects[k];
+        double m00 = obj->sum[MOMENT_INDEX(0, 0)];
+
+        shift_moments(obj, 0.0, 0.0, raw);
+        if (m00 != 0.0) {
+            shift_moments(obj,
+                          obj->ref_x + obj->sum[MOMENT_INDEX(1, 0)] / m00,
+                          obj->ref_y + obj->sum[MOMENT_INDEX(0, 1)] / m00,
+                          central);
+        } else {
+            for (j = 0; j < NUM_MOMENTS; j++)
+                central[j] = mxGetNaN();
+        }
+
+        for (j = 0; j < NUM_MOMENTS; j++) {
+            M[(mwSize) j * nobj + k - 1] = raw[j];
+            MU[(mwSize) j * nobj + k - 1] = central[j];
+        }
+        count[k - 1] = obj->count;
+    }
+
+    mxFree(objects);
+}
+
+template<typename I_T>
+static void dispatch_labels(const I_T *I, const mxArray *labeled, mwSize rows,
+                            mwSize cols, mxArray *plhs[])
+{
+    void *L;
+
+    if (labeled == NULL || mxIsEmpty(labeled)) {
+        compute_objmoments(I, (const uint8_T *) NULL, rows, cols, plhs);
+        return;
+    }
+
+    L = mxGetData(labeled);
+    switch (mxGetClassID(labeled)) {
+    case mxDOUBLE_CLASS:
+        compute_objmoments(I, (const double *) L, rows, cols, plhs);
+        break;
+    case mxINT32_CLASS:
+        compute_objmoments(I, (const int32_T *) L, rows, cols, plhs);
+        break;
+    case mxUINT32_CLASS:
+        compute_objmoments(I, (const uint32_T *) L, rows, cols, plhs);
+        break;
+    case mxUINT16_CLASS:
+        compute_objmoments(I, (const uint16_T *) L, rows, cols, plhs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        compute_objmoments(I, (const uint8_T *) L, rows, cols, plhs);
+        break;
+    default:
+        mexErrMsgTxt("LABELED must be of class double, int32, uint32, "
+                     "uint16, uint8 or logical.");
+    }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mxArray *outputs[3];
+    const mxArray *labeled = NULL;
+    mwSize rows, cols;
+    void *I;
+    int k;
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgTxt("[M, MU, COUNT] = ml_objmoments(IMAGE, LABELED), raw and "
+                     "central moments up to order 4 of every object.");
+    } else if (nlhs > 3) {
+        mexErrMsgTxt("ml_objmoments returns at most three outputs.");
+    }
+
+    if ((!mxIsNumeric(prhs[0]) && !mxIsLogical(prhs[0])) ||
+        mxIsComplex(prhs[0]) || mxGetNumberOfDimensions(prhs[0]) != 2) {
+        mexErrMsgTxt("IMAGE must be a real 2D matrix.");
+    }
+
+    rows = mxGetM(prhs[0]);
+    cols = mxGetN(prhs[0]);
+
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+        labeled = prhs[1];
+        if (mxGetM(labeled) != rows || mxGetN(labeled) != cols ||
+            mxGetNumberOfDimensions(labeled) != 2) {
+            mexErrMsgTxt("LABELED must be the same size as IMAGE.");
+        }
+    }
+
+    I = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        dispatch_labels((const double *) I, labeled, rows, cols, outputs);
+        break;
+    case mxSINGLE_CLASS:
+        dispatch_labels((const float *) I, labeled, rows, cols, outputs);
+        break;
+    case mxINT32_CLASS:
+        dispatch_labels((const int32_T *) I, labeled, rows, cols, outputs);
+        break;
+    case mxUINT16_CLASS:
+        dispatch_labels((const uint16_T *) I, labeled, rows, cols, outputs);
+        break;
+    case mxUINT8_CLASS:
+    case mxLOGICAL_CLASS:
+        dispatch_labels((const uint8_T *) I, labeled, rows, cols, outputs);
+        break;
+    default:
+        mexErrMsgTxt("IMAGE must be of class double, single, int32, uint16, "
+                     "uint8 or logical.");
+    }
+
+    for (k = 0; k < 3; k++) {
+        if (k < nlhs || (k == 0 && nlhs == 0))
+            plhs[k] = outputs[k];
+        else
+            mxDestroyArray(outputs[k]);
+    }
+}
@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_objzernike.cpp
+//
+//  Zernike moments for ALL objects of a labeled image; per-object
+//  replacement for calling ml_zernike once per object image.
+//
+//  Z = ml_objzernike(IMAGE, LABELED, D, R)
+//  where:
+//     -IMAGE is a 2D image (uint8, uint16, int32, single or double)
+//     -LABELED is a matrix with size==IMAGE (double, int32, uint8,
+//      uint16 or uint32), e.g. generated by BWLABEL.  Label 0 is
+//      background.
+//     -D is the degree through which the moments are calculated
+//     -R is the maximum radius (in pixels) of the Zernike polynomials
+//     -Z is a complex N x numMoments matrix, N = max(LABELED(:)).  Row k
+//      holds the moments of object k in the same order as ml_zernike:
+//      for n=0:D, for l=0:n, if mod(n-l,2)==0.
+//
+//  Each row matches ml_zernike(IMAGE.*(LABELED==k), D, R): the centroid
+//  is the center of fluorescence of the object's nonzero pixels and the
+//  pixel weights are normalized by the object's total fluorescence.
+//
+//  The image is scanned twice: once to count the pixels of every object
+//  and once to bucket the pixel indices by label.  Centroids and moments
+//  are then computed in parallel over objects (when compiled with
+//  OpenMP), with all (n,l) evaluated per pixel from one table of radial
+//  polynomial coefficients.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+//
+// Calculates n! (uses double arithmetic to avoid overflow)
+//
+static double factorial(double n)
+{
+    double result = 1.0;
+
+    if (n < 0)
+        return 0.0;
+    for (; n > 1.0; n -= 1.0)
+        result *= n;
+    return result;
+}
+
+//
+// Number of (n,l) pairs with 0 <= l <= n <= D and n-l even
+//
+static int num_moments(int D)
+{
+    int n, l, count = 0;
+
+    for (n = 0; n <= D; n++)
+        for (l = 0; l <= n; l++)
+            if ((n - l) % 2 == 0)
+                count++;
+    return count;
+}
+
+//
+// Radial polynomial coefficients.  For moment k, R_nl(rho) is
+// sum over j of coef[k*(D+1) + j] * rho^j.
+//
+static void make_radial_table(int D, int *nk, int *lk, double *coef)
+{
+    int n, l, m, k = 0;
+
+    memset(coef, 0, num_moments(D) * (D + 1) * sizeof(double));
+    for (n = 0; n <= D; n++) {
+        for (l = 0; l <= n; l++) {
+            if ((n - l) % 2 != 0)
+                continue;
+            nk[k] = n;
+            lk[k] = l;
+            for (m = 0; m <= (n - l) / 2; m++) {
+                coef[k * (D + 1) + n - 2 * m] =
+                    ((m % 2) ? -1.0 : 1.0) * factorial(n - m) /
+                    (factorial(m) * factorial((n - 2 * m + l) / 2) *
+                     factorial((n - 2 * m - l) / 2));
+            }
+            k++;
+        }
+    }
+}
+
+//
+// Reads a label as a nonnegative integer; anything else is background
+//
+template<typename L_T>
+static inline int label_at(const L_T *L, mwSize p)
+{
+    double v = (double) L[p];
+    return (v >= 1.0) ? (int) v : 0;
+}
+
+//
+// Raster scans that bucket the pixel indices of every object.  Returns
+// the number of objects.  Only nonzero pixels (find(I)) are kept.
+//
+template<typename I_T, typename L_T>
+static int bucket_pixels(const I_T *I, const L_T *L, mwSize N,
+                         mwSize **start, mwSize **pixels)
+{
+    int nobj = 0;
+    mwSize p;
+    int k;
+
+    for (p = 0; p < N; p++) {
+        k = label_at(L, p);
+        if (k > nobj)
+            nobj = k;
+    }
+
+    mwSize *first = (mwSize *) mxCalloc((mwSize) nobj + 2, sizeof(mwSize));
+
+    for (p = 0; p < N; p++) {
+        k = label_at(L, p);
+        if (k == 0 || I[p] == 0)
+            continue;
+        first[k + 1]++;
+    }
+    for (k = 1; k <= nobj + 1; k++)
+        first[k] += first[k - 1];
+
+    mwSize *next = (mwSize *) mxMalloc(((mwSize) nobj + 1) * sizeof(mwSize));
+    mwSize *pix = (mwSize *) mxMalloc((first[nobj + 1] + 1) * sizeof(mwSize));
+    memcpy(next, first, ((mwSize) nobj + 1) * sizeof(mwSize));
+
+    /* pixels are visited in column-major order, matching find(I) */
+    for (p = 0; p < N; p++) {
+        k = label_at(L, p);
+        if (k == 0 || I[p] == 0)
+            continue;
+        pix[next[k]++] = p;
+    }
+    mxFree(next);
+
+    *start = first;
+    *pixels = pix;
+    return nobj;
+}
+
+//
+// Zernike moments of one object from its bucketed pixel list; scratch
+// holds 3*(D+1) doubles
+//
+template<typename I_T>
+static void object_zernike(const I_T *I, mwSize rows, const mwSize *pix,
+                           mwSize npix, double R, int D, int K,
+                           const int *lk, const double *coef,
+                           double *scratch, double *zr, double *zi)
+{
+    double m00 = 0.0, m10 = 0.0, m01 = 0.0;
+    double *rpow = scratch;
+    double *cosl = scratch + (D + 1);
+    double *sinl = scratch + 2 * (D + 1);
+    mwSize i;
+    int k, j;
+
+    for (k = 0; k < K; k++)
+        zr[k] = zi[k] = 0.0;
+
+    /* center of fluorescence, 1-based coordinates as in ml_imgmoments */
+    for (i = 0; i < npix; i++) {
+        double p = (double) I[pix[i]];
+        m00 += p;
+        m10 += p * (double) (pix[i] / rows + 1);
+        m01 += p * (double) (pix[i] % rows + 1);
+    }
+
+    if (m00 != 0.0) {
+        double cx = m10 / m00;
+        double cy = m01 / m00;
+
+        for (i = 0; i < npix; i++) {
+            double x = ((double) (pix[i] / rows + 1) - cx) / R;
+            double y = ((double) (pix[i] % rows + 1) - cy) / R;
+            double r2 = x * x + y * y;
+
+            if (r2 > 1.0)
+                continue;
+
+            double p = (double) I[pix[i]] / m00;
+            double rho = sqrt(r2);
+            double c1 = (rho > 0.0) ? x / rho : 1.0;
+            double s1 = (rho > 0.0) ? y / rho : 0.0;
+
+            /* powers of rho and exp(i*l*theta) by recurrence */
+            rpow[0] = 1.0;
+            cosl[0] = 1.0;
+            sinl[0] = 0.0;
+            for (j = 1; j <= D; j++) {
+                rpow[j] = rpow[j - 1] * rho;
+                cosl[j] = cosl[j - 1] * c1 - sinl[j - 1] * s1;
+                sinl[j] = sinl[j - 1] * c1 + cosl[j - 1] * s1;
+            }
+
+            for (k = 0; k < K; k++) {
+                const double *c = coef + k * (D + 1);
+                double radial = 0.0;
+                for (j = 0; j <= D; j++)
+                    radial += c[j] * rpow[j];
+                /* p * conj(V_nl) */
+                zr[k] += p * radial * cosl[lk[k]];
+                zi[k] -= p * radial * sinl[lk[k]];
+            }
+        }
+    }
+}
+
+template<typename I_T, typename L_T>
+static mxArray *compute_objzernike(const I_T *I, const L_T *L, mwSize rows,
+                                   mwSize N, int D, double R)
+{
+    int K = num_moments(D);
+    int *nk = (int *) mxMalloc(K * sizeof(int));
+    int *lk = (int *) mxMalloc(K * sizeof(int));
+    double *coef = (double *) mxMalloc(K * (D + 1) * sizeof(double));
+    mwSize *start, *pixels;
+    int nobj, obj, k;
+
+    make_radial_table(D, nk, lk, coef);
+    nobj = bucket_pixels(I, L, N, &start, &pixels);
+
+    mxArray *result = mxCreateDoubleMatrix(nobj, K, mxCOMPLEX);
+    double *zr = mxGetPr(result);
+    double *zi = mxGetPi(result);
+
+    /* per-object results, written back transposed into the N x K output */
+    double *buf = (double *) mxMalloc(2 * (mwSize) K * ((mwSize) nobj + 1) *
+                                      sizeof(double));
+
+    /* per-thread scratch; the mx allocators must not be called by threads */
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    double *scratch = (double *) mxMalloc(3 * (mwSize) (D + 1) * nthreads *
+                                          sizeof(double));
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) private(k) num_threads(nthreads)
+#endif
+    for (obj = 1; obj <= nobj; obj++) {
+        double *br = buf + 2 * (mwSize) K * obj;
+        double *bi = br + K;
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+
+        object_zernike(I, rows, pixels + start[obj], start[obj + 1] - start[obj],
+                       R, D, K, lk, coef, scratch + 3 * (mwSize) (D + 1) * tid,
+                       br, bi);
+        for (k = 0; k < K; k++) {
+            zr[(mwSize) k * nobj + obj - 1] = br[k] * (nk[k] + 1) / M_PI;
+            zi[(mwSize) k * nobj + obj - 1] = bi[k] * (nk[k] + 1) / M_PI;
+        }
+    }
+
+    mxFree(buf);
+    mxFree(scratch);
+    mxFree(start);
+    mxFree(pixels);
+    mxFree(nk);
+    mxFree(lk);
+    mxFree(coef);
+    return result;
+}
+
+template<typename I_T>
+static mxArray *dispatch_labels(const I_T *I, const mxArray *labeled,
+                                mwSize rows, mwSize N, int D, double R)
+{
+    void *L = mxGetData(labeled);
+
+    switch (mxGetClassID(labeled)) {
+    case mxDOUBLE_CLASS:
+        return compute_objzernike(I, (const double *) L, rows, N, D, R);
+    case mxINT32_CLASS:
+        return compute_objzernike(I, (const int32_T *) L, rows, N, D, R);
+    case mxUINT32_CLASS:
+        return compute_objzernike(I, (const uint32_T *) L, rows, N, D, R);
+    case mxUINT16_CLASS:
+        return compute_objzernike(I, (const uint16_T *) L, rows, N, D, R);
+    case mxUINT8_CLASS:
+        return compute_objzernike(I, (const uint8_T *) L, rows, N, D, R);
+    default:
+        mexErrMsgTxt("LABELED must be of class double, int32, uint32, "
+                     "uint16 or uint8.");
+    }
+    return NULL;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mwSize rows, N;
+    int D;
+    double R;
+    void *I;
+
+    if (nrhs != 4) {
+        mexErrMsgTxt("Z = ml_objzernike(IMAGE, LABELED, D, R), Zernike "
+                     "moments through degree D of every object in LABELED.");
+    } else if (nlhs > 1) {
+        mexErrMsgTxt("ml_objzernike returns a single output.");
+    }
+
+    if (!mxIsNumeric(prhs[0]) || mxIsComplex(prhs[0]) ||
+        mxGetNumberOfDimensions(prhs[0]) != 2) {
+        mexErrMsgTxt("IMAGE must be a real 2D numeric matrix.");
+    }
+
+    if (mxGetM(prhs[0]) != mxGetM(prhs[1]) ||
+        mxGetN(prhs[0]) != mxGetN(prhs[1]) ||
+        mxGetNumberOfDimensions(prhs[1]) != 2) {
+        mexErrMsgTxt("LABELED must be the same size as IMAGE.");
+    }
+
+    if (mxGetNumberOfElements(prhs[2]) != 1 || mxGetScalar(prhs[2]) < 0) {
+        mexErrMsgTxt("D should be a nonnegative scalar.");
+    }
+
+    if (mxGetNumberOfElements(prhs[3]) != 1 || !(mxGetScalar(prhs[3]) > 0)) {
+        mexErrMsgTxt("R should be a positive scalar.");
+    }
+
+    rows = mxGetM(prhs[0]);
+    N = mxGetNumberOfElements(prhs[0]);
+    D = (int) mxGetScalar(prhs[2]);
+    R = mxGetScalar(prhs[3]);
+    I = mxGetData(prhs[0]);
+
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        plhs[0] = dispatch_labels((const double *) I, prhs[1], rows, N, D, R);
+        break;
+    case mxSINGLE_CLASS:
+        plhs[0] = dispatch_labels((const float *) I, prhs[1], rows, N, D, R);
+        break;
+    case mxINT32_CLASS:
+        plhs[0] = dispatch_labels((const int32_T *) I, prhs[1], rows, N, D, R);
+        break;
+    case mxUINT16_CLASS:
+        plhs[0] = dispatch_labels((const uint16_T *) I, prhs[1], rows, N, D, R);
+        break;
+    case mxUINT8_CLASS:
+        plhs[0] = dispatch_labels((const uint8_T *) I, prhs[1], rows, N, D, R);
+        break;
+    default:
+        mexErrMsgTxt("IMAGE must be of class double, single, int32, uint16 "
+                     "or uint8.");
+    }
+}
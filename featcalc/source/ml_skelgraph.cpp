@@ -0,0 +1,517 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_skelgraph.cpp
+//
+//  Graph of the skeleton of every object in an image: nodes (end points
+//  and junctions), edges between them with their lengths, and counts.
+//
+//  [STATS, NODES, EDGES] = ml_skelgraph(SKEL, LABELED)
+//  where:
+//     -SKEL is a 2D skeleton image (e.g. from ml_thin); nonzero pixels
+//      are skeleton
+//     -LABELED (optional) is a label matrix with size==SKEL (double,
+//      int32, uint32, uint16, uint8 or logical) giving the object of
+//      each skeleton pixel; label 0 is ignored.  If omitted or [], the
+//      whole skeleton is one object (and STATS has one row even if the
+//      skeleton is empty).
+//     -STATS is an N x 6 matrix, N = max(LABELED(:)), with one row
+//        [pixels endpoints junctions edges length branchpoints]
+//      per object: the number of skeleton pixels, of end point and
+//      junction nodes, of edges, the total edge length, and the number
+//      of pixels with 3 or more 4-neighbors (ml_find_branch_points).
+//     -NODES is a K x 5 matrix [label row col type degree], one row per
+//      node; row/col is the mean position of the node pixels, type is
+//      1 for end points, 2 for junctions and 0 for isolated pixels and
+//      the anchor of closed loops, degree is the number of edge ends.
+//     -EDGES is an E x 5 matrix [label node1 node2 length pixels], with
+//      node1/node2 rows of NODES, the length of the path (1 per axial
+//      and sqrt(2) per diagonal step) and its number of interior pixels.
+//
+//  Pixels are connected by m-adjacency: 4-neighbors always, diagonal
+//  neighbors only when they share no 4-neighbor in the skeleton.  This
+//  removes the spurious triangles of 8-adjacency at the corners of
+//  staircases, so a pixel with 2 neighbors is always on a path, 1 is an
+//  end point and 3 or more a junction.  Adjacent junction pixels form a
+//  single node.  Objects are processed in parallel with OpenMP.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+#define NUM_STATS 6
+#define NODE_COLS 5
+#define EDGE_COLS 5
+
+#define NODE_ISOLATED 0
+#define NODE_END      1
+#define NODE_JUNCTION 2
+
+typedef struct SkelNode_tag
+{
+    double row_sum;
+    double col_sum;
+    int    npix;
+    int    type;
+    int    degree;
+} SkelNode_T;
+
+typedef struct SkelEdge_tag
+{
+    int    node1;
+    int    node2;
+    double length;
+    int    npix;
+} SkelEdge_T;
+
+typedef struct SkelImage_tag
+{
+    const mwSize *label;   /* object of each skeleton pixel, 0 elsewhere */
+    mwSize rows;
+    mwSize cols;
+    unsigned char *degree; /* m-degree of each skeleton pixel */
+    char *visited;         /* path pixels already on an edge */
+    int *node_of;          /* node (local to the object) of node pixels */
+} SkelImage_T;
+
+static const int nb_dr[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+static const int nb_dc[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+
+static inline bool in_object(const SkelImage_T *img, long r, long c, mwSize k)
+{
+    return r >= 0 && c >= 0 && r < (long) img->rows && c < (long) img->cols &&
+        img->label[(mwSize) c * img->rows + r] == k;
+}
+
+//
+// m-neighbors of pixel p of object k; returns their number
+//
+static int m_neighbors(const SkelImage_T *img, mwSize p, mwSize k,
+                       mwSize *nb, double *step)
+{
+    long r = (long) (p % img->rows), c = (long) (p / img->rows);
+    int i, n = 0;
+
+    for (i = 0; i < 8; i++) {
+        long rr = r + nb_dr[i], cc = c + nb_dc[i];
+
+        if (!in_object(img, rr, cc, k))
+            continue;
+        /* diagonal: only if neither shared 4-neighbor is skeleton */
+        if (i >= 4 && (in_object(img, rr, c, k) || in_object(img, r, cc, k)))
+            continue;
+        nb[n] = (mwSize) cc * img->rows + rr;
+        step[n] = (i >= 4) ? M_SQRT2 : 1.0;
+        n++;
+    }
+    return n;
+}
+
+static int count_4neighbors(const SkelImage_T *img, mwSize p, mwSize k)
+{
+    long r = (long) (p % img->rows), c = (long) (p / img->rows);
+    int i, n = 0;
+
+    for (i = 0; i < 4; i++)
+        n += in_object(img, r + nb_dr[i], c + nb_dc[i], k);
+    return n;
+}
+
+//
+// Follows the path leaving node pixel s through q up to the next node
+// pixel and records the edge
+//
+static void trace_edge(SkelImage_T *img, mwSize k, mwSize s, mwSize q,
+                       double step, SkelNode_T *nodes, SkelEdge_T *edges,
+                       int *nedges)
+{
+    mwSize nb[8], prev = s, cur = q;
+    double st[8], length = step;
+    int i, n, npix = 0;
+    SkelEdge_T *e;
+
+    while (img->node_of[cur] < 0) {
+        mwSize next = cur;
+        double next_step = 0.0;
+
+        img->visited[cur] = 1;
+        npix++;
+        n = m_neighbors(img, cur, k, nb, st);
+        for (i = 0; i < n; i++) {
+            if (nb[i] != prev && (img->node_of[nb[i]] >= 0 || !img->visited[nb[i]])) {
+                next = nb[i];
+                next_step = st[i];
+                break;
+            }
+        }
+        if (next == cur)
+            return;   /* cannot happen on a pixel of degree 2 */
+        length += next_step;
+        prev = cur;
+        cur = next;
+    }
+
+    e = &edges[(*nedges)++];
+    e->node1 = img->node_of[s];
+    e->node2 = img->node_of[cur];
+    e->length = length;
+    e->npix = npix;
+    nodes[e->node1].degree++;
+    nodes[e->node2].degree++;
+}
+
+static int new_node(SkelImage_T *img, mwSize p, int type, SkelNode_T *nodes,
+                    int *nnodes)
+{
+    SkelNode_T *node = &nodes[*nnodes];
+
+    node->row_sum = (double) (p % img->rows + 1);
+    node->col_sum = (double) (p / img->rows + 1);
+    node->npix = 1;
+    node->type = type;
+    node->degree = 0;
+    img->node_of[p] = *nnodes;
+    return (*nnodes)++;
+}
+
+//
+// Graph of object k from its pixel list; nodes, edges and stack hold
+// at least npix, 4*npix and npix entries
+//
+static void object_graph(SkelImage_T *img, mwSize k, const mwSize *pix,
+                         mwSize npix, SkelNode_T *nodes, int *nnodes,
+                         SkelEdge_T *edges, int *nedges, mwSize *stack,
+                         double *stats)
+{
+    mwSize nb[8];
+    double st[8];
+    mwSize i;
+    int j, n;
+
+    *nnodes = *nedges = 0;
+    memset(stats, 0, NUM_STATS * sizeof(double));
+    stats[0] = (double) npix;
+
+    for (i = 0; i < npix; i++) {
+        img->degree[pix[i]] = (unsigned char) m_neighbors(img, pix[i], k, nb, st);
+        if (count_4neighbors(img, pix[i], k) >= 3)
+            stats[5]++;
+    }
+
+    /* end points, isolated pixels and clusters of junction pixels */
+    for (i = 0; i < npix; i++) {
+        mwSize p = pix[i];
+        int d = img->degree[p], id;
+
+        if (d == 2 || img->node_of[p] >= 0)
+            continue;
+        if (d < 2) {
+            new_node(img, p, d == 1 ? NODE_END : NODE_ISOLATED, nodes, nnodes);
+            continue;
+        }
+
+        id = new_node(img, p, NODE_JUNCTION, nodes, nnodes);
+        mwSize top = 0;
+        stack[top++] = p;
+        while (top > 0) {
+            mwSize q = stack[--top];
+            n = m_neighbors(img, q, k, nb, st);
+            for (j = 0; j < n; j++) {
+                if (img->degree[nb[j]] >= 3 && img->node_of[nb[j]] < 0) {
+                    img->node_of[nb[j]] = id;
+                    nodes[id].row_sum += (double) (nb[j] % img->rows + 1);
+                    nodes[id].col_sum += (double) (nb[j] / img->rows + 1);
+                    nodes[id].npix++;
+                    stack[top++] = nb[j];
+                }
+            }
+        }
+    }
+
+    /* edges leaving every node pixel */
+    for (i = 0; i < npix; i++) {
+        mwSize p = pix[i];
+
+        if (img->node_of[p] < 0)
+            continue;
+        n = m_neighbors(img, p, k, nb, st);
+        for (j = 0; j < n; j++) {
+            mwSize q = nb[j];
+
+            if (img->node_of[q] >= 0) {
+                /* adjacent nodes, counted once per pixel pair */
+                if (img->node_of[q] != img->node_of[p] && p < q) {
+                    SkelEdge_T *e = &edges[(*nedges)++];
+                    e->node1 = img->node_of[p];
+                    e->node2 = img->node_of[q];
+                    e->length = st[j];
+                    e->npix = 0;
+                    nodes[e->node1].degree++;
+                    nodes[e->node2].degree++;
+                }
+            } else if (!img->visited[q]) {
+                trace_edge(img, k, p, q, st[j], nodes, edges, nedges);
+            }
+        }
+    }
+
+    /* closed loops have no node; anchor one on their first pixel */
+    for (i = 0; i < npix; i++) {
+        mwSize p = pix[i];
+
+        if (img->node_of[p] >= 0 || img->visited[p])
+            continue;
+        new_node(img, p, NODE_ISOLATED, nodes, nnodes);
+        n = m_neighbors(img, p, k, nb, st);
+        for (j = 0; j < n; j++) {
+            if (!img->visited[nb[j]] && img->node_of[nb[j]] < 0)
+                trace_edge(img, k, p, nb[j], st[j], nodes, edges, nedges);
+        }
+    }
+
+    for (j = 0; j < *nnodes; j++) {
+        if (nodes[j].type == NODE_END)
+            stats[1]++;
+        else if (nodes[j].type == NODE_JUNCTION)
+            stats[2]++;
+    }
+    stats[3] = (double) *nedges;
+    for (j = 0; j < *nedges; j++)
+        stats[4] += edges[j].length;
+}
+
+template<typename L_T>
+static void label_skeleton(const mxArray *skel, const L_T *L, mwSize *label)
+{
+    mwSize p, N = mxGetNumberOfElements(skel);
+    const void *data = mxGetData(skel);
+
+    for (p = 0; p < N; p++) {
+        double s, v;
+
+        switch (mxGetClassID(skel)) {
+        case mxDOUBLE_CLASS: s = ((const double *) data)[p]; break;
+        case mxSINGLE_CLASS: s = ((const float *) data)[p]; break;
+        case mxUINT16_CLASS: s = ((const uint16_T *) data)[p]; break;
+        default:             s = ((const uint8_T *) data)[p]; break;
+        }
+        if (s == 0.0) {
+            label[p] = 0;
+            continue;
+        }
+        v = (L == NULL) ? 1.0 : (double) L[p];
+        label[p] = (v >= 1.0) ? (mwSize) v : 0;
+    }
+}
+
+static void skeleton_graph(const mxArray *skel, const mwSize *label,
+                           mwSize nobj, mxArray *plhs[])
+{
+    mwSize rows = mxGetM(skel), cols = mxGetN(skel), N = rows * cols;
+    mwSize p, k;
+    long obj;
+    int nthreads = 1;
+
+    for (p = 0; p < N; p++)
+        if (label[p] > nobj)
+            nobj = label[p];
+
+    /* bucket the skeleton pixels by object */
+    mwSize *start = (mwSize *) mxCalloc(nobj + 2, sizeof(mwSize));
+    for (p = 0; p < N; p++)
+        if (label[p] > 0)
+            start[label[p] + 1]++;
+    for (k = 1; k <= nobj + 1; k++)
+        start[k] += start[k - 1];
+    mwSize total = start[nobj + 1];
+    mwSize *next = (mwSize *) mxMalloc((nobj + 1) * sizeof(mwSize));
+    mwSize *pix = (mwSize *) mxMalloc((total + 1) * sizeof(mwSize));
+    memcpy(next, start, (nobj + 1) * sizeof(mwSize));
+    for (p = 0; p < N; p++)
+        if (label[p] > 0)
+            pix[next[label[p]]++] = p;
+    mxFree(next);
+
+    SkelImage_T img;
+    img.label = label;
+    img.rows = rows;
+    img.cols = cols;
+    img.degree = (unsigned char *) mxCalloc(N + 1, sizeof(unsigned char));
+    img.visited = (char *) mxCalloc(N + 1, sizeof(char));
+    img.node_of = (int *) mxMalloc((N + 1) * sizeof(int));
+    for (p = 0; p < N; p++)
+        img.node_of[p] = -1;
+
+    /* objects only touch their own pixels and slices of these buffers */
+    SkelNode_T *nodes = (SkelNode_T *) mxMalloc((total + 1) * sizeof(SkelNode_T));
+    SkelEdge_T *edges = (SkelEdge_T *) mxMalloc((4 * total + 1) * sizeof(SkelEdge_T));
+    mwSize *stack = (mwSize *) mxMalloc((total + 1) * sizeof(mwSize));
+    int *nnodes = (int *) mxCalloc(nobj + 1, sizeof(int));
+    int *nedges = (int *) mxCalloc(nobj + 1, sizeof(int));
+    double *stats = (double *) mxCalloc(NUM_STATS * (nobj + 1), sizeof(double));
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads)
+#endif
+    for (obj = 1; obj <= (long) nobj; obj++) {
+        object_graph(&img, (mwSize) obj, pix + start[obj],
+                     start[obj + 1] - start[obj], nodes + start[obj],
+                     &nnodes[obj], edges + 4 * start[obj], &nedges[obj],
+                     stack + start[obj], stats + NUM_STATS * obj);
+    }
+
+    /* concatenate in label order; node numbers become rows of NODES */
+    mwSize K = 0, E = 0;
+    for (k = 1; k <= nobj; k++) {
+        K += nnodes[k];
+        E += nedges[k];
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(nobj, NUM_STATS, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(K, NODE_COLS, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(E, EDGE_COLS, mxREAL);
+    double *S = mxGetPr(plhs[0]);
+    double *nodes_out = mxGetPr(plhs[1]);
+    double *edges_out = mxGetPr(plhs[2]);
+    mwSize kn = 0, ke = 0;
+    int j;
+
+    for (k = 1; k <= nobj; k++) {
+        const SkelNode_T *nd = nodes + start[k];
+        const SkelEdge_T *ed = edges + 4 * start[k];
+        mwSize first = kn;
+
+        for (j = 0; j < NUM_STATS; j++)
+            S[j * nobj + k - 1] = stats[NUM_STATS * k + j];
+        for (j = 0; j < nnodes[k]; j++, kn++) {
+            nodes_out[kn] = (double) k;
+            nodes_out[K + kn] = nd[j].row_sum / nd[j].npix;
+            nodes_out[2 * K + kn] = nd[j].col_sum / nd[j].npix;
+            nodes_out[3 * K + kn] = (double) nd[j].type;
+            nodes_out[4 * K + kn] = (double) nd[j].degree;
+        }
+        for (j = 0; j < nedges[k]; j++, ke++) {
+            edges_out[ke] = (double) k;
+            edges_out[E + ke] = (double) (first + ed[j].node1 + 1);
+            edges_out[2 * E + ke] = (double) (first + ed[j].node2 + 1);
+            edges_out[3 * E + ke] = ed[j].length;
+            edges_out[4 * E + ke] = (double) ed[j].npix;
+        }
+    }
+
+    mxFree(start);
+    mxFree(pix);
+    mxFree(img.degree);
+    mxFree(img.visited);
+    mxFree(img.node_of);
+    mxFree(nodes);
+    mxFree(edges);
+    mxFree(stack);
+    mxFree(nnodes);
+    mxFree(nedges);
+    mxFree(stats);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mxArray *outputs[3];
+    const mxArray *labeled = NULL;
+    mwSize *label;
+    void *L;
+    int k;
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgTxt("[STATS, NODES, EDGES] = ml_skelgraph(SKEL, LABELED), "
+                     "skeleton graph of every object.");
+    } else if (nlhs > 3) {
+        mexErrMsgTxt("ml_skelgraph returns at most three outputs.");
+    }
+
+    if (mxGetNumberOfDimensions(prhs[0]) != 2 || mxIsComplex(prhs[0]) ||
+        !(mxIsLogical(prhs[0]) || mxIsDouble(prhs[0]) || mxIsSingle(prhs[0]) ||
+          mxIsUint8(prhs[0]) || mxIsUint16(prhs[0]))) {
+        mexErrMsgTxt("SKEL must be a 2D logical, uint8, uint16, single or "
+                     "double matrix.");
+    }
+
+    if (nrhs > 1 && !mxIsEmpty(prhs[1])) {
+        labeled = prhs[1];
+        if (mxGetM(labeled) != mxGetM(prhs[0]) ||
+            mxGetN(labeled) != mxGetN(prhs[0]) ||
+            mxGetNumberOfDimensions(labeled) != 2) {
+            mexErrMsgTxt("LABELED must be the same size as SKEL.");
+        }
+    }
+
+    label = (mwSize *) mxMalloc((mxGetNumberOfElements(prhs[0]) + 1) *
+                                sizeof(mwSize));
+    if (labeled == NULL) {
+        label_skeleton(prhs[0], (const uint8_T *) NULL, label);
+    } else {
+        L = mxGetData(labeled);
+        switch (mxGetClassID(labeled)) {
+        case mxDOUBLE_CLASS:
+            label_skeleton(prhs[0], (const double *) L, label);
+            break;
+        case mxINT32_CLASS:
+            label_skeleton(prhs[0], (const int32_T *) L, label);
+            break;
+        case mxUINT32_CLASS:
+            label_skeleton(prhs[0], (const uint32_T *) L, label);
+            break;
+        case mxUINT16_CLASS:
+            label_skeleton(prhs[0], (const uint16_T *) L, label);
+            break;
+        case mxUINT8_CLASS:
+        case mxLOGICAL_CLASS:
+            label_skeleton(prhs[0], (const uint8_T *) L, label);
+            break;
+        default:
+            mexErrMsgTxt("LABELED must be of class double, int32, uint32, "
+                         "uint16, uint8 or logical.");
+        }
+    }
+
+    /* without labels there is always one object, possibly empty */
+    skeleton_graph(prhs[0], label, labeled == NULL ? 1 : 0, outputs);
+    mxFree(label);
+
+    for (k = 0; k < 3; k++) {
+        if (k < nlhs || (k == 0 && nlhs == 0))
+            plhs[k] = outputs[k];
+        else
+            mxDestroyArray(outputs[k]);
+    }
+}
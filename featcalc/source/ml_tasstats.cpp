@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_tasstats.cpp
+//
+//  Threshold adjacency statistics (TAS and nTAS) of a 2D or 3D image in
+//  a single pass.
+//
+//  VALUES = ml_tasstats(IMAGE, LOW, HIGH)
+//  where:
+//     -IMAGE is a 2D or 3D image (uint8, uint16, int32, single or double)
+//     -LOW and HIGH define the binary image B = (IMAGE > LOW) & (IMAGE < HIGH)
+//     -VALUES is [TAS NTAS], with, for a 2D image, 9 bins each:
+//        TAS(n+1)  = fraction of the pixels with B==1 that have n
+//                    neighbors with B==0
+//        NTAS(n+1) = fraction of the pixels with B==0 that have n
+//                    neighbors with B==1
+//      over the 8-neighborhood, as computed by ml_tas.  For a 3D image
+//      the 26-neighborhood is used and each histogram has 27 bins.
+//      Only pixels whose whole neighborhood lies inside the image are
+//      counted (the 'valid' part of a convolution).  An empty
+//      histogram gives NaN.
+//
+//  B is built one plane at a time and the neighbor counts are 3x3 box
+//  sums of it (three column sums per pixel, kept from one column to the
+//  next), added over three consecutive planes in 3D.  3D volumes are
+//  split into slabs of planes processed in parallel with OpenMP.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAX_BINS 27
+
+//
+// B for plane z
+//
+template<typename I_T>
+static void binarize_plane(const I_T *I, mwSize npix, double low, double high,
+                           unsigned char *B)
+{
+    mwSize p;
+
+    for (p = 0; p < npix; p++) {
+        double v = (double) I[p];
+        B[p] = (unsigned char) (v > low && v < high);
+    }
+}
+
+//
+// 3x3 box sums of B at the interior pixels of a rows x cols plane
+//
+static void box_sums(const unsigned char *B, mwSize rows, mwSize cols,
+                     unsigned char *S)
+{
+    mwSize r, c;
+
+    if (rows < 3)
+        return;
+    for (c = 1; c + 1 < cols; c++) {
+        const unsigned char *left = B + (c - 1) * rows;
+        const unsigned char *mid = B + c * rows;
+        const unsigned char *right = B + (c + 1) * rows;
+        unsigned char *out = S + c * rows;
+        /* column sums of the 3 columns at rows r-1 and r */
+        unsigned int prev = left[0] + mid[0] + right[0];
+        unsigned int cur = left[1] + mid[1] + right[1];
+
+        for (r = 1; r + 1 < rows; r++) {
+            unsigned int next = left[r + 1] + mid[r + 1] + right[r + 1];
+            out[r] = (unsigned char) (prev + cur + next);
+            prev = cur;
+            cur = next;
+        }
+    }
+}
+
+//
+// Adds the interior pixels of plane B to the histograms; S holds the
+// box sums to use (already summed over 3 planes in 3D)
+//
+static void count_plane(const unsigned char *B, const unsigned char *S,
+                        mwSize rows, mwSize cols, int nneighbors,
+                        double *tas, double *ntas)
+{
+    mwSize r, c;
+
+    for (c = 1; c + 1 < cols; c++) {
+        for (r = 1; r + 1 < rows; r++) {
+            mwSize p = c * rows + r;
+            int n = S[p] - B[p];
+
+            if (B[p])
+                tas[nneighbors - n]++;
+            else
+                ntas[n]++;
+        }
+    }
+}
+
+template<typename I_T>
+static void tas_2d(const I_T *I, mwSize rows, mwSize cols, double low,
+                   double high, double *tas, double *ntas)
+{
+    mwSize npix = rows * cols;
+    unsigned char *B = (unsigned char *) mxMalloc(npix + 1);
+    unsigned char *S = (unsigned char *) mxMalloc(npix + 1);
+
+    binarize_plane(I, npix, low, high, B);
+    box_sums(B, rows, cols, S);
+    count_plane(B, S, rows, cols, 8, tas, ntas);
+
+    mxFree(B);
+    mxFree(S);
+}
+
+template<typename I_T>
+static void tas_3d(const I_T *I, mwSize rows, mwSize cols, mwSize slices,
+                   double low, double high, double *tas, double *ntas)
+{
+    mwSize npix = rows * cols;
+    int nthreads = 1;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    /* per thread: 3 planes of B, 3 planes of box sums, their total and */
+    /* two histograms; the mx allocators must not be called by threads */
+    unsigned char *planes = (unsigned char *) mxMalloc(7 * npix * nthreads + 1);
+    double *hist = (double *) mxCalloc(2 * MAX_BINS * nthreads, sizeof(double));
+    int t, n;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        int tid = 0, nt = 1;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        unsigned char *B[3], *S[3];
+        unsigned char *total = planes + 7 * npix * tid + 6 * npix;
+        double *my_tas = hist + 2 * MAX_BINS * tid;
+        double *my_ntas = my_tas + MAX_BINS;
+        /* interior planes 1..slices-2, split in contiguous slabs */
+        long inner = (long) slices - 2;
+        long z0 = 1 + inner * tid / nt, z1 = 1 + inner * (tid + 1) / nt;
+        long z;
+        mwSize p;
+        int j;
+
+        for (j = 0; j < 3; j++) {
+            B[j] = planes + 7 * npix * tid + j * npix;
+            S[j] = planes + 7 * npix * tid + (3 + j) * npix;
+        }
+
+        for (z = z0 - 1; z <= z1 && z0 < z1; z++) {
+            /* ring of the last three planes: z-2, z-1, z */
+            unsigned char *b = B[z % 3], *s = S[z % 3];
+
+            binarize_plane(I + (mwSize) z * npix, npix, low, high, b);
+            box_sums(b, rows, cols, s);
+            if (z < z0 + 1)
+                continue;
+
+            for (p = 0; p < npix; p++)
+                total[p] = (unsigned char) (S[0][p] + S[1][p] + S[2][p]);
+            count_plane(B[(z - 1) % 3], total, rows, cols, 26, my_tas, my_ntas);
+        }
+    }
+
+    for (t = 0; t < nthreads; t++) {
+        for (n = 0; n < MAX_BINS; n++) {
+            tas[n] += hist[2 * MAX_BINS * t + n];
+            ntas[n] += hist[2 * MAX_BINS * t + MAX_BINS + n];
+        }
+    }
+
+    mxFree(planes);
+    mxFree(hist);
+}
+
+template<typename I_T>
+static void compute_tas(const I_T *I, const mwSize *dims, mwSize ndims,
+                        double low, double high, double *tas, double *ntas)
+{
+    if (ndims == 2)
+        tas_2d(I, dims[0], dims[1], low, high, tas, ntas);
+    else
+        tas_3d(I, dims[0], dims[1], dims[2], low, high, tas, ntas);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    double tas[MAX_BINS], ntas[MAX_BINS];
+    double low, high, ntotal, nntotal;
+    const mwSize *dims;
+    mwSize ndims;
+    int nbins, n;
+    double *values;
+    void *I;
+
+    if (nrhs != 3) {
+        mexErrMsgTxt("VALUES = ml_tasstats(IMAGE, LOW, HIGH), threshold "
+                     "adjacency statistics.");
+    } else if (nlhs > 1) {
+        mexErrMsgTxt("ml_tasstats returns a single output.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if (!mxIsNumeric(prhs[0]) || mxIsComplex(prhs[0]) || ndims > 3) {
+        mexErrMsgTxt("IMAGE must be a real 2D or 3D matrix.");
+    }
+    if (mxGetNumberOfElements(prhs[1]) != 1 ||
+        mxGetNumberOfElements(prhs[2]) != 1) {
+        mexErrMsgTxt("LOW and HIGH must be scalars.");
+    }
+
+    dims = mxGetDimensions(prhs[0]);
+    low = mxGetScalar(prhs[1]);
+    high = mxGetScalar(prhs[2]);
+    nbins = (ndims == 2) ? 9 : 27;
+    memset(tas, 0, sizeof(tas));
+    memset(ntas, 0, sizeof(ntas));
+
+    I = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        compute_tas((const double *) I, dims, ndims, low, high, tas, ntas);
+        break;
+    case mxSINGLE_CLASS:
+        compute_tas((const float *) I, dims, ndims, low, high, tas, ntas);
+        break;
+    case mxINT32_CLASS:
+        compute_tas((const int32_T *) I, dims, ndims, low, high, tas, ntas);
+        break;
+    case mxUINT16_CLASS:
+        compute_tas((const uint16_T *) I, dims, ndims, low, high, tas, ntas);
+        break;
+    case mxUINT8_CLASS:
+        compute_tas((const uint8_T *) I, dims, ndims, low, high, tas, ntas);
+        break;
+    default:
+        mexErrMsgTxt("IMAGE must be of class double, single, int32, uint16 "
+                     "or uint8.");
+    }
+
+    ntotal = nntotal = 0.0;
+    for (n = 0; n < nbins; n++) {
+        ntotal += tas[n];
+        nntotal += ntas[n];
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(1, 2 * nbins, mxREAL);
+    values = mxGetPr(plhs[0]);
+    for (n = 0; n < nbins; n++) {
+        values[n] = tas[n] / ntotal;
+        values[nbins + n] = ntas[n] / nntotal;
+    }
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*
+//  Thinning of a binary image by repeated hit-or-miss with the eight
+//  structuring elements of ml_mmthin, until no pixel changes.
+//
+//  SKEL = ml_thin(BW)
+//  SKEL = ml_thin(BW, MODE)
+//  where:
+//     -BW is a 2D image; nonzero pixels are foreground
+//     -MODE is 'frontier' (default) or 'sweep', see below; both give
+//      the same result
+//     -SKEL is a logical matrix with size==BW, equal to ml_mmthin(BW)
+//
+//  The image is kept bit-packed, 64 pixels of a column per word, with
+//  an empty column on each side.  The 3x3 neighborhood of 64 pixels is
+//  then nine words (shifts of the word and of its neighbors in the
+//  same and adjacent columns), and a structuring element is matched
+//  with 8 ANDs.  As in ml_mmthin each element is applied to the whole
+//  image before the next one: the hits of a pass are computed from
+//  the current image, in parallel, and removed at the end of the pass.
+//
+//  'sweep' evaluates every word in every pass.  'frontier' keeps a
+//  queue of the words that can still change: after the first round an
+//  element can only hit a word again if a pixel in its 3x3 word
+//  neighborhood was removed since that element was last applied, i.e.
+//  during the last NUM_ELEMS passes.  Each pass then costs O(boundary)
+//  instead of O(image).
+*/
+
+#include "mex.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define NUM_ELEMS 8
+#define WORD_BITS 64
+
+typedef uint64_T word_T;
+
+/* struct_elem{k} of ml_mmthin: 0 background, 1 foreground, 2 don't care */
+static const int struct_elem[NUM_ELEMS][3][3] = {
+  {{0, 0, 0}, {2, 1, 2}, {1, 1, 1}},
+  {{2, 0, 0}, {1, 1, 0}, {1, 1, 2}},
+  {{1, 2, 0}, {1, 1, 0}, {1, 2, 0}},
+  {{1, 1, 2}, {1, 1, 0}, {2, 0, 0}},
+  {{1, 1, 1}, {2, 1, 2}, {0, 0, 0}},
+  {{2, 1, 1}, {0, 1, 1}, {0, 0, 2}},
+  {{0, 2, 1}, {0, 1, 1}, {0, 2, 1}},
+  {{0, 0, 2}, {0, 1, 1}, {2, 1, 1}}
+};
+
+/* packed image: (cols + 2) columns of nwords words; columns 0 and */
+/* cols + 1 stay empty so that every column has two neighbors */
+typedef struct {
+  word_T *bits;
+  mwSize rows;
+  mwSize cols;
+  mwSize nwords;
+} packed_image;
+
+/* hit-or-miss of element k on word w of column c (1..cols) */
+static word_T hitmiss_word(const packed_image *img, int k, mwSize c, mwSize w)
+{
+  word_T hit = ~(word_T) 0;
+  int dr, dc;
+
+  for (dc = 0; dc < 3; dc++) {
+    const word_T *col = img->bits + (c + dc - 1) * img->nwords;
+    word_T center = col[w];
+    word_T prev = (w > 0) ? col[w - 1] : 0;
+    word_T next = (w + 1 < img->nwords) ? col[w + 1] : 0;
+    word_T nb[3];
+
+    /* bit i of nb[dr] is the pixel at row i + dr - 1 */
+    nb[0] = (center << 1) | (prev >> (WORD_BITS - 1));
+    nb[1] = center;
+    nb[2] = (center >> 1) | (next << (WORD_BITS - 1));
+
+    for (dr = 0; dr < 3; dr++) {
+      if (struct_elem[k][dr][dc] == 1)
+        hit &= nb[dr];
+      else if (struct_elem[k][dr][dc] == 0)
+        hit &= ~nb[dr];
+    }
+  }
+
+  return hit;
+}
+
+/* one pass of element k over the whole image; returns nonzero if any */
+/* pixel was removed */
+static int thin_pass(packed_image *img, word_T *hits, int k)
+{
+  mwSize nwords = img->nwords;
+  long c;
+  int changed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(|:changed)
+#endif
+  for (c = 1; c <= (long) img->cols; c++) {
+    mwSize w;
+
+    for (w = 0; w < nwords; w++) {
+      word_T hit = hitmiss_word(img, k, c, w);
+
+      hits[c * nwords + w] = hit;
+      changed |= (hit != 0);
+    }
+  }
+
+  if (changed) {
+    mwSize i, n = (img->cols + 2) * nwords;
+
+    for (i = 0; i < n; i++)
+      img->bits[i] &= ~hits[i];
+  }
+
+  return changed;
+}
+
+/* apply the eight elements in turn until a full round changes nothing */
+static void thin_sweep(packed_image *img)
+{
+  word_T *hits = (word_T *) mxCalloc((img->cols + 2) * img->nwords,
+                                     sizeof(word_T));
+  int k, changed;
+
+  do {
+    changed = 0;
+    for (k = 0; k < NUM_ELEMS; k++)
+      changed |= thin_pass(img, hits, k);
+  } while (changed);
+
+  mxFree(hits);
+}
+
+/* mark word i and the words whose neighborhood contains the removed */
+/* pixels 'hit' of word i as changed in pass 'pass', queueing them */
+static void touch_neighbors(const packed_image *img, mwSize i, word_T hit,
+                            long pass, long *stamp, char *queued,
+                            mwSize *queue, mwSize *length)
+{
+  mwSize nwords = img->nwords;
+  mwSize w = i % nwords;
+  int dc, dw;
+
+  for (dc = -1; dc <= 1; dc++) {
+    for (dw = -1; dw <= 1; dw++) {
+      mwSize j;
+
+      /* rows above/below the word only see its first/last bit */
+      if (dw == -1 && (w == 0 || !(hit & 1)))
+        continue;
+      if (dw == 1 && (w + 1 == nwords || !(hit >> (WORD_BITS - 1))))
+        continue;
+
+      j = i + dc * (long) nwords + dw;
+      stamp[j] = pass;
+      if (!queued[j]) {
+        queued[j] = 1;
+        queue[(*length)++] = j;
+      }
+    }
+  }
+}
+
+/* same result as thin_sweep, only evaluating the words of a queue */
+static void thin_frontier(packed_image *img)
+{
+  mwSize nwords = img->nwords;
+  mwSize total = (img->cols + 2) * nwords;
+  long *stamp = (long *) mxCalloc(total, sizeof(long));
+  char *queued = (char *) mxCalloc(total, sizeof(char));
+  mwSize *queue = (mwSize *) mxCalloc(total, sizeof(mwSize));
+  mwSize *next = (mwSize *) mxCalloc(total, sizeof(mwSize));
+  word_T *hits = (word_T *) mxCalloc(total, sizeof(word_T));
+  mwSize length = 0, next_length, i, *tmp;
+  long pass, n;
+
+  /* every nonempty word is a candidate in the first round (stamp 0) */
+  for (i = nwords; i < total - nwords; i++) {
+    if (img->bits[i] != 0) {
+      queued[i] = 1;
+      queue[length++] = i;
+    }
+  }
+
+  for (pass = 1; length > 0; pass++) {
+    int k = (int) ((pass - 1) % NUM_ELEMS);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (n = 0; n < (long) length; n++) {
+      mwSize j = queue[n];
+      hits[n] = hitmiss_word(img, k, j / nwords, j % nwords);
+    }
+
+    for (n = 0; n < (long) length; n++)
+      img->bits[queue[n]] &= ~hits[n];
+
+    /* keep the words that changed or saw a change in the last */
+    /* NUM_ELEMS passes, then add the neighbors of this pass's hits */
+    next_length = 0;
+    for (n = 0; n < (long) length; n++) {
+      mwSize j = queue[n];
+
+      queued[j] = 0;
+      if (img->bits[j] != 0 && stamp[j] > pass - NUM_ELEMS) {
+        queued[j] = 1;
+        next[next_length++] = j;
+      }
+    }
+    for (n = 0; n < (long) length; n++) {
+      if (hits[n] != 0)
+        touch_neighbors(img, queue[n], hits[n], pass, stamp, queued,
+                        next, &next_length);
+    }
+
+    /* drop the empty words queued as neighbors */
+    length = 0;
+    for (n = 0; n < (long) next_length; n++) {
+      mwSize j = next[n];
+
+      if (img->bits[j] != 0)
+        next[length++] = j;
+      else
+        queued[j] = 0;
+    }
+
+    tmp = queue;
+    queue = next;
+    next = tmp;
+  }
+
+  mxFree(stamp);
+  mxFree(queued);
+  mxFree(queue);
+  mxFree(next);
+  mxFree(hits);
+}
+
+#define PACK_IMAGE(TYPE)                                        \
+  {                                                             \
+    const TYPE *p = (const TYPE *) data;                        \
+    for (c = 0; c < img->cols; c++) {                           \
+      word_T *col = img->bits + (c + 1) * img->nwords;          \
+      for (r = 0; r < img->rows; r++, p++)                      \
+        if (*p != 0)                                            \
+          col[r / WORD_BITS] |= (word_T) 1 << (r % WORD_BITS);  \
+    }                                                           \
+  }
+
+static void pack_image(const mxArray *array, packed_image *img)
+{
+  const void *data = mxGetData(array);
+  mwSize r, c;
+
+  img->rows = mxGetM(array);
+  img->cols = mxGetN(array);
+  img->nwords = (img->rows + WORD_BITS - 1) / WORD_BITS;
+  img->bits = (word_T *) mxCalloc((img->cols + 2) * img->nwords,
+                                  sizeof(word_T));
+
+  switch (mxGetClassID(array)) {
+  case mxLOGICAL_CLASS:
+  case mxUINT8_CLASS:
+  case mxINT8_CLASS:
+    PACK_IMAGE(uint8_T);
+    break;
+  case mxUINT16_CLASS:
+  case mxINT16_CLASS:
+    PACK_IMAGE(uint16_T);
+    break;
+  case mxUINT32_CLASS:
+  case mxINT32_CLASS:
+    PACK_IMAGE(uint32_T);
+    break;
+  case mxSINGLE_CLASS:
+    PACK_IMAGE(float);
+    break;
+  case mxDOUBLE_CLASS:
+    PACK_IMAGE(double);
+    break;
+  default:
+    mexErrMsgTxt("BW must be a logical or numeric matrix");
+  }
+}
+
+static void unpack_image(const packed_image *img, mxLogical *out)
+{
+  mwSize r, c;
+
+  for (c = 0; c < img->cols; c++) {
+    const word_T *col = img->bits + (c + 1) * img->nwords;
+    for (r = 0; r < img->rows; r++, out++)
+      *out = (mxLogical) ((col[r / WORD_BITS] >> (r % WORD_BITS)) & 1);
+  }
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  packed_image img;
+  int frontier = 1;
+
+  if (nrhs < 1 || nrhs > 2)
+    mexErrMsgTxt("SKEL = ml_thin(BW, MODE)");
+  if (nlhs > 1)
+    mexErrMsgTxt("ml_thin returns a single output");
+  if (mxGetNumberOfDimensions(prhs[0]) != 2 || mxIsComplex(prhs[0]))
+    mexErrMsgTxt("BW must be a real 2D matrix");
+
+  if (nrhs == 2) {
+    char mode[16];
+
+    if (!mxIsChar(prhs[1]) || mxGetString(prhs[1], mode, sizeof(mode)) != 0)
+      mexErrMsgTxt("MODE must be 'frontier' or 'sweep'");
+    if (strcmp(mode, "sweep") == 0)
+      frontier = 0;
+    else if (strcmp(mode, "frontier") != 0)
+      mexErrMsgTxt("MODE must be 'frontier' or 'sweep'");
+  }
+
+  pack_image(prhs[0], &img);
+  if (frontier)
+    thin_frontier(&img);
+  else
+    thin_sweep(&img);
+
+  plhs[0] = mxCreateLogicalMatrix(img.rows, img.cols);
+  unpack_image(&img, mxGetLogicals(plhs[0]));
+
+  mxFree(img.bits);
+}
@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_zernikecache.cpp
+//
+//  Zernike moments of fixed-size crops from a cached basis.
+//
+//  Z = ml_zernikecache(IMAGES, D, R)
+//  Z = ml_zernikecache(IMAGES, D, R, CENTER)
+//  ml_zernikecache('clear')
+//  where:
+//     -IMAGES is a rows x cols x nimages stack of crops (uint8, uint16,
+//      single or double)
+//     -D is the degree through which the moments are calculated
+//     -R is the maximum radius (in pixels) of the Zernike polynomials
+//     -CENTER is [row col] of the polynomial origin in 1-based pixel
+//      coordinates; default is the center of the grid
+//     -Z is a complex nimages x numMoments matrix, in the same order as
+//      ml_zernike: for n=0:D, for l=0:n, if mod(n-l,2)==0.
+//
+//  For a fixed (R, D, grid size, center) the sampled polynomials
+//  (n+1)/pi * conj(V_nl(x,y)) are the same for every crop, so they are
+//  evaluated once and kept in memory between calls as contiguous
+//  single precision real and imaginary planes, zero outside the unit
+//  disk.  Each image then costs one small matrix-vector product, which
+//  the compiler vectorizes; images are processed in parallel with OpenMP.
+//
+//  The result equals ml_zernike(IMAGE, D, R) whenever the center of
+//  fluorescence of IMAGE is CENTER (e.g. crops centered on the cell);
+//  otherwise it is the moment about CENTER.  Weights are normalized by
+//  the total fluorescence of each image, as in ml_zernike.
+//
+//  ml_zernikecache('clear') frees all cached bases.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_CACHED_BASES 8
+
+typedef struct ZernikeBasis_tag
+{
+    /* cache key */
+    double  radius;
+    int     degree;
+    mwSize  rows;
+    mwSize  cols;
+    double  center_row;
+    double  center_col;
+
+    /* num_moments planes of rows*cols values each */
+    int     num_moments;
+    float  *re;
+    float  *im;
+
+    unsigned long last_used;
+} ZernikeBasis_T;
+
+static ZernikeBasis_T cache[MAX_CACHED_BASES];
+static int            cache_size = 0;
+static unsigned long  cache_clock = 0;
+
+static void free_basis(ZernikeBasis_T *basis)
+{
+    mxFree(basis->re);
+    mxFree(basis->im);
+    basis->re = NULL;
+    basis->im = NULL;
+}
+
+static void clear_cache(void)
+{
+    int i;
+
+    for (i = 0; i < cache_size; i++)
+        free_basis(&cache[i]);
+    cache_size = 0;
+}
+
+//
+// Calculates n! (uses double arithmetic to avoid overflow)
+//
+static double factorial(double n)
+{
+    double result = 1.0;
+
+    if (n < 0)
+        return 0.0;
+    for (; n > 1.0; n -= 1.0)
+        result *= n;
+    return result;
+}
+
+static int num_moments(int D)
+{
+    int n, l, count = 0;
+
+    for (n = 0; n <= D; n++)
+        for (l = 0; l <= n; l++)
+            if ((n - l) % 2 == 0)
+                count++;
+    return count;
+}
+
+//
+// Samples (n+1)/pi * conj(V_nl) on the grid for every (n,l)
+//
+static void build_basis(ZernikeBasis_T *basis)
+{
+    int D = basis->degree;
+    mwSize rows = basis->rows;
+    mwSize npix = basis->rows * basis->cols;
+    int K = num_moments(D);
+    mwSize p;
+    int n, l, m, k;
+
+    basis->num_moments = K;
+    basis->re = (float *) mxCalloc((mwSize) K * npix, sizeof(float));
+    basis->im = (float *) mxCalloc((mwSize) K * npix, sizeof(float));
+    mexMakeMemoryPersistent(basis->re);
+    mexMakeMemoryPersistent(basis->im);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(n, l, m, k)
+#endif
+    for (p = 0; p < npix; p++) {
+        double x = ((double) (p / rows + 1) - basis->center_col) / basis->radius;
+        double y = ((double) (p % rows + 1) - basis->center_row) / basis->radius;
+        double rho = sqrt(x * x + y * y);
+        double theta = atan2(y, x);
+
+        if (rho > 1.0)
+            continue;
+
+        for (k = 0, n = 0; n <= D; n++) {
+            for (l = 0; l <= n; l++) {
+                double radial = 0.0;
+
+                if ((n - l) % 2 != 0)
+                    continue;
+                for (m = 0; m <= (n - l) / 2; m++) {
+                    radial += ((m % 2) ? -1.0 : 1.0) * factorial(n - m) /
+                        (factorial(m) * factorial((n - 2 * m + l) / 2) *
+                         factorial((n - 2 * m - l) / 2)) *
+                        pow(rho, (double) (n - 2 * m));
+                }
+                radial *= (n + 1) / M_PI;
+                basis->re[(mwSize) k * npix + p] = (float) (radial * cos(l * theta));
+                basis->im[(mwSize) k * npix + p] = (float) (-radial * sin(l * theta));
+                k++;
+            }
+        }
+    }
+}
+
+//
+// Returns the cached basis for the key, building it (and evicting the
+// least recently used entry) on a miss
+//
+static ZernikeBasis_T *get_basis(double R, int D, mwSize rows, mwSize cols,
+                                 double crow, double ccol)
+{
+    ZernikeBasis_T *basis;
+    int i;
+
+    cache_clock++;
+    for (i = 0; i < cache_size; i++) {
+        basis = &cache[i];
+        if (basis->radius == R && basis->degree == D &&
+            basis->rows == rows && basis->cols == cols &&
+            basis->center_row == crow && basis->center_col == ccol) {
+            basis->last_used = cache_clock;
+            return basis;
+        }
+    }
+
+    if (cache_size < MAX_CACHED_BASES) {
+        basis = &cache[cache_size++];
+    } else {
+        basis = &cache[0];
+        for (i = 1; i < cache_size; i++)
+            if (cache[i].last_used < basis->last_used)
+                basis = &cache[i];
+        free_basis(basis);
+    }
+
+    basis->radius = R;
+    basis->degree = D;
+    basis->rows = rows;
+    basis->cols = cols;
+    basis->center_row = crow;
+    basis->center_col = ccol;
+    basis->last_used = cache_clock;
+    build_basis(basis);
+
+    return basis;
+}
+
+template<typename I_T>
+static void compute_moments(const I_T *images, mwSize nimages,
+                            const ZernikeBasis_T *basis, double *zr, double *zi)
+{
+    mwSize npix = basis->rows * basis->cols;
+    int K = basis->num_moments;
+    long img;
+    int nthreads = 1;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    /* per-thread image buffers; the mx allocators are not thread safe */
+    float *buffers = (float *) mxMalloc(npix * nthreads * sizeof(float));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        float *f = buffers;
+        mwSize p;
+        int k;
+
+#ifdef _OPENMP
+        f += npix * omp_get_thread_num();
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (img = 0; img < (long) nimages; img++) {
+            const I_T *I = images + (mwSize) img * npix;
+            double total = 0.0;
+
+            for (p = 0; p < npix; p++) {
+                f[p] = (float) I[p];
+                total += (double) I[p];
+            }
+
+            for (k = 0; k < K; k++) {
+                const float *bre = basis->re + (mwSize) k * npix;
+                const float *bim = basis->im + (mwSize) k * npix;
+                double sr = 0.0, si = 0.0;
+
+                /* without -ffast-math the reductions only vectorize
+                   when asked to */
+#ifdef _OPENMP
+#pragma omp simd reduction(+:sr, si)
+#endif
+                for (p = 0; p < npix; p++) {
+                    sr += bre[p] * f[p];
+                    si += bim[p] * f[p];
+                }
+                zr[(mwSize) k * nimages + img] = (total != 0.0) ? sr / total : 0.0;
+                zi[(mwSize) k * nimages + img] = (total != 0.0) ? si / total : 0.0;
+            }
+        }
+    }
+
+    mxFree(buffers);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const mwSize *dims;
+    mwSize ndims, rows, cols, nimages;
+    double R, crow, ccol;
+    int D;
+    ZernikeBasis_T *basis;
+    void *I;
+
+    mexAtExit(clear_cache);
+
+    if (nrhs == 1 && mxIsChar(prhs[0])) {
+        char command[16];
+        mxGetString(prhs[0], command, sizeof(command));
+        if (strcmp(command, "clear") != 0)
+            mexErrMsgTxt("Unknown command; use ml_zernikecache('clear').");
+        clear_cache();
+        return;
+    }
+
+    if (nrhs != 3 && nrhs != 4) {
+        mexErrMsgTxt("Z = ml_zernikecache(IMAGES, D, R, CENTER), Zernike "
+                     "moments of fixed-size crops from a cached basis.");
+    } else if (nlhs > 1) {
+        mexErrMsgTxt("ml_zernikecache returns a single output.");
+    }
+
+    if (!mxIsNumeric(prhs[0]) || mxIsComplex(prhs[0]) ||
+        mxGetNumberOfDimensions(prhs[0]) > 3) {
+        mexErrMsgTxt("IMAGES must be a real rows x cols x nimages array.");
+    }
+
+    if (mxGetNumberOfElements(prhs[1]) != 1 || mxGetScalar(prhs[1]) < 0) {
+        mexErrMsgTxt("D should be a nonnegative scalar.");
+    }
+
+    if (mxGetNumberOfElements(prhs[2]) != 1 || !(mxGetScalar(prhs[2]) > 0)) {
+        mexErrMsgTxt("R should be a positive scalar.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    dims = mxGetDimensions(prhs[0]);
+    rows = dims[0];
+    cols = dims[1];
+    nimages = (ndims == 3) ? dims[2] : 1;
+    D = (int) mxGetScalar(prhs[1]);
+    R = mxGetScalar(prhs[2]);
+
+    if (nrhs == 4) {
+        if (!mxIsDouble(prhs[3]) || mxGetNumberOfElements(prhs[3]) != 2)
+            mexErrMsgTxt("CENTER should be a double vector [row col].");
+        crow = mxGetPr(prhs[3])[0];
+        ccol = mxGetPr(prhs[3])[1];
+    } else {
+        crow = (rows + 1) / 2.0;
+        ccol = (cols + 1) / 2.0;
+    }
+
+    basis = get_basis(R, D, rows, cols, crow, ccol);
+
+    plhs[0] = mxCreateDoubleMatrix(nimages, basis->num_moments, mxCOMPLEX);
+    I = mxGetData(prhs[0]);
+
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        compute_moments((const double *) I, nimages, basis,
+                        mxGetPr(plhs[0]), mxGetPi(plhs[0]));
+        break;
+    case mxSINGLE_CLASS:
+        compute_moments((const float *) I, nimages, basis,
+                        mxGetPr(plhs[0]), mxGetPi(plhs[0]));
+        break;
+    case mxUINT16_CLASS:
+        compute_moments((const uint16_T *) I, nimages, basis,
+                        mxGetPr(plhs[0]), mxGetPi(plhs[0]));
+        break;
+    case mxUINT8_CLASS:
+        compute_moments((const uint8_T *) I, nimages, basis,
+                        mxGetPr(plhs[0]), mxGetPi(plhs[0]));
+        break;
+    default:
+        mexErrMsgTxt("IMAGES must be of class double, single, uint16 or uint8.");
+    }
+}
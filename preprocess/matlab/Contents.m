@@ -28,6 +28,7 @@
 % Cropping
 %   ml_threshcrop        - Generate a mask image
 %   ml_nihthreshold      - Find an NIH threshold value
+%   ml_histthresh        - NIH, RC, Kapur, Yen and Otsu thresholds from one histogram
 %
 % Background subtraction
 %   ml_imbgbsub          - Background subtraction
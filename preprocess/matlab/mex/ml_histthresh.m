@@ -0,0 +1,42 @@
+function [THRESH, HISTO] = ml_histthresh(IMAGE,METHODS)
+% [THRESH, HISTO] = ML_HISTTHRESH(IMAGE,METHODS) histogram thresholds of an image
+% ML_HISTTHRESH(IMAGE,METHODS),
+%     Builds one histogram of IMAGE and evaluates the threshold
+%     criteria listed in METHODS on it, one THRESH value per method:
+%        'nih'   - 255*ML_THRESHOLD(IMAGE)
+%        'rc'    - ML_RCTHRESHOLD(IMAGE)
+%        'kapur' - ML_KAPURTHRESHOLD(IMAGE)
+%        'yen'   - ML_YENTHRESHOLD(IMAGE)
+%        'otsu'  - 255*GRAYTHRESH(IMAGE)
+%     METHODS is one name or a cell array of names; all five are
+%     evaluated, in this order, when it is omitted.  HISTO is the
+%     histogram, IMHIST(IMAGE(:),256) or IMHIST(IMAGE(:),65536).
+%
+%     IMAGE may be uint8 or uint16.  For uint16 images the 'nih' and
+%     'otsu' values, which use 256 bins, are scaled by 257, and 'kapur'
+%     and 'yen' are NaN when IMAGE has values above 255.  The histogram
+%     is built in parallel when the MEX file is compiled with OpenMP.
+%
+%     See also ML_THRESHOLD, ML_RCTHRESHOLD, ML_KAPURTHRESHOLD,
+%     ML_YENTHRESHOLD, ML_THRESHCROP
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
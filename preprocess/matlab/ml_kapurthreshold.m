@@ -35,33 +35,8 @@ function threshold = ml_kapurthreshold(img)
         error('ml_kapurthreshold: img should not have values greater than 255 (scale it first)');
     end
     img=uint8(img);
-    histo = imhist(img,256);
-    histo(1)=[];
-    cumhisto=cumsum(histo);
-    histo = histo ./cumhisto(end);
-    cumhisto=cumhisto ./ cumhisto(end);
-
-    Best=-1;
-    threshold=-1;
-    T=1;
-
-    while cumhisto(T) == 0,
-        T = T + 1;
-    end
-    while cumhisto(T) < cumhisto(end),
-        value = ml_entropy(histo(1:T)/cumhisto(T)) + ml_entropy(histo(T+1:end)/(1-cumhisto(T)));
-        if value > Best,
-            threshold=T;
-            Best = value;
-        end
-        T = T + 1;
-    end
+    threshold = ml_histthresh(img,'kapur');
     disp(['Result: ' num2str(threshold)])
 end
 
-function H = ml_entropy(P),
-    P(P==0)=1;
-    H=-sum(P.*log(P));
-end
-
 % vim: set ts=4 sts=4 expandtab smartindent:
@@ -48,65 +48,10 @@ function threshold = ml_rcthreshold(img)
 % Jan 14, 2013 D. Sullivan Modified code to now take uint16 or uint8 image
 
 % $Id: ml_rcthreshold.m,v 1.3 2006/06/27 13:33:47 tingz Exp $
-%
-% Generate a bin histogram
-
-imgsize=size(img);
-
-if length(imgsize)>2
-    img=reshape(img,imgsize(1),prod(imgsize(2:end)));
-end
 
-%1/14/13 D. Sullivan - added uint16 capabilities using if-elseif-else and
-%changed error statement accordingly
-if strcmp(class(img),'uint8')==1
-    histo = imhist(img(:),256);
-    histo(1) = [];
-    histo(255) = 0;
-elseif strcmp(class(img),'uint16')==1
-    histo = imhist(img(:),65536);
-    histo(1) = [];
-    histo(65535) = 0;
-else
+if ~isa(img,'uint8') && ~isa(img,'uint16')
     error('Wrong data type! The image should be uint16 or uint8.');
 end
 
-hsum = sum(histo);
-
-whitepos=find(histo>0);
-MinIndex=1;
-MaxIndex=1;
-if ~isempty(whitepos) 
-    MinIndex=whitepos(1);
-    MaxIndex=whitepos(end);
-end
-
-if (MinIndex >= MaxIndex)
-	threshold = MinIndex;
-	warning('There is <= 1 nonzero pixel intensity');
-	return;
-end;
-
-MovingIndex = MinIndex+1;
-
-Prev = MinIndex;
-while (Prev ~= MovingIndex)
-    if (MovingIndex >= MaxIndex)
-        break;
-    end;
-    
-    sum1 = sum([MinIndex:MovingIndex-1]' .* ...
-        histo(MinIndex:MovingIndex-1)) ;
-    sum2 = sum(histo(MinIndex:MovingIndex-1)) ;
-    sum3 = sum([MovingIndex:MaxIndex]' .* ...
-        histo(MovingIndex:MaxIndex)) ;
-    sum4 = sum(histo(MovingIndex:MaxIndex)) ;
-    
-    Prev = MovingIndex;
-    loweravg=sum1/sum2;
-    higheravg=sum3/sum4;
-    
-    MovingIndex = ceil((loweravg + higheravg)/2) ;   
-end
-
-threshold = MovingIndex;
+% 256 or 65536 bin histogram, without its first and last bins
+threshold = ml_histthresh(img,'rc');
@@ -6,6 +6,8 @@ function mask = ml_threshcrop(image, cropimage, method)
 %    entirety of IMAGE.  Thresholding is done BEFORE applying
 %    the region of interest.  The image is cleaned using the 
 %    majority operation of bwmorph.
+% ML_THRESHCROP(IMAGE, CROPIMAGE, METHOD) thresholds with METHOD,
+%    'nih' (default), 'rc', 'kapur', 'yen' or 'otsu'.
 %
 % 06 Aug 98
 %   - 10 Jan 1999 : renamed to reflect the order of operations
@@ -49,6 +51,10 @@ case 'rc'
     Iscaled = uint8(floor(ml_rcscale(image))) ;
     Timage = ml_rcthreshold(Iscaled);
     Ithresh = im2bw(Iscaled, Timage/255) ;
+case {'kapur','yen','otsu'}
+    Iscaled = uint8(floor(ml_rcscale(image))) ;
+    Timage = ml_histthresh(Iscaled, method);
+    Ithresh = im2bw(Iscaled, Timage/255) ;
 otherwise
     error(['Unknown thresholding method "' method '"'])
 end
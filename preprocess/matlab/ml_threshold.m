@@ -45,6 +45,20 @@ function threshold = ml_threshold(image)
 
 % $Id: ml_threshold.m,v 1.2 2006/06/27 13:33:47 tingz Exp $
 
+% imhist(IMAGE,256) of a floating point image has the bins of
+% im2uint8(IMAGE); ml_histthresh returns 255 minus the level below
+if isfloat(image)
+    image = im2uint8(image);
+end
+if isa(image,'uint8') || isa(image,'uint16')
+    T = ml_histthresh(image,'nih');
+    if isa(image,'uint16')
+        T = T/257;
+    end
+    threshold = 1 - (255 - T)/255;
+    return
+end
+
 %
 % Generate a 256 bin histogram and 'flip' it.
 %
@@ -36,31 +36,6 @@ function threshold = ml_yenthreshold(img)
     end
 
     img=uint8(img);
-    RHO=2;
-
-    histo = imhist(img,256);
-    histo(1)=[];
-    cumhisto=cumsum(histo);
-    histo = histo ./cumhisto(end);
-    cumhisto=cumhisto ./ cumhisto(end);
-
-    cumhisto_r=cumsum(histo .^ RHO);
-
-    Best=-1;
-    threshold=-1;
-    T=1;
-
-    while cumhisto_r(T) == 0,
-        T = T + 1;
-    end
-    while cumhisto_r(T) < cumhisto_r(end),
-        value = - log( cumhisto_r(T) / cumhisto(T)^RHO) ...
-                - log( ( cumhisto_r(end) - cumhisto_r(T)) / ((1-cumhisto(T))^RHO) );
-        if value > Best,
-            threshold=T;
-            Best = value
-        end
-        T = T + 1;
-    end
+    threshold = ml_histthresh(img,'yen');
 
 % vim: set ts=4 sw=4 sts=4 expandtab smartindent:
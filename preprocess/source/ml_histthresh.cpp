@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_histthresh.cpp
+//
+//  Histogram threshold selection: the NIH, Ridler-Calvard, Kapur, Yen
+//  and Otsu thresholds of an image from a single histogram.
+//
+//  [THRESH, HISTO] = ml_histthresh(IMAGE, METHODS)
+//  where:
+//     -IMAGE is an image of class uint8 or uint16, of any size
+//     -METHODS (optional) is one of 'nih', 'rc', 'kapur', 'yen' and
+//      'otsu' or a cell array of them; all five by default, in that
+//      order
+//     -THRESH holds one threshold per method, in gray levels of IMAGE:
+//        nih   - 255*ml_threshold(IMAGE), exactly 255 minus the level
+//                ml_threshold computes
+//        rc    - ml_rcthreshold(IMAGE)
+//        kapur - ml_kapurthreshold(IMAGE)
+//        yen   - ml_yenthreshold(IMAGE)
+//        otsu  - 255*graythresh(IMAGE)
+//      For uint16 images nih and otsu, which work on 256 bins as imhist
+//      makes them, are multiplied by 257, and kapur and yen are NaN if
+//      IMAGE has values above 255 (the MATLAB functions refuse them).
+//     -HISTO is the 256 or 65536 bin histogram of IMAGE
+//
+//  The histogram is built in parallel with OpenMP, one per thread,
+//  and each criterion is then evaluated in O(bins) from prefix sums.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+enum { NIH, RC, KAPUR, YEN, OTSU, NMETHODS };
+
+static const char *method_names[NMETHODS] = { "nih", "rc", "kapur", "yen",
+                                              "otsu" };
+
+template<typename I_T>
+static void image_histogram(const I_T *I, mwSize n, mwSize nbins,
+                            double *histo)
+{
+    int nthreads = 1, t;
+    mwSize b;
+
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+    if (n < 65536)
+        nthreads = 1;
+#endif
+    /* one histogram per thread; the mx allocators must not be called */
+    /* by threads */
+    mwSize *partial = (mwSize *) mxCalloc(nbins * nthreads, sizeof(mwSize));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        mwSize *h = partial;
+        long p;
+
+#ifdef _OPENMP
+        h += nbins * omp_get_thread_num();
+#pragma omp for schedule(static)
+#endif
+        for (p = 0; p < (long) n; p++)
+            h[I[p]]++;
+    }
+
+    for (t = 0; t < nthreads; t++)
+        for (b = 0; b < nbins; b++)
+            histo[b] += (double) partial[nbins * t + b];
+    mxFree(partial);
+}
+
+//
+// ml_threshold: 255 minus the level found on the flipped histogram
+// F(i) = H(256-i), i = 1..256, without its end bins
+//
+static double nih_threshold(const double *H)
+{
+    double F[257], C[257], S[257], result;
+    int minidx = 1, maxidx = 256, moving, i;
+
+    F[0] = C[0] = S[0] = 0.0;
+    for (i = 1; i <= 256; i++) {
+        F[i] = (i > 1 && i < 256) ? H[256 - i] : 0.0;
+        C[i] = C[i - 1] + F[i];
+        S[i] = S[i - 1] + i * F[i];
+    }
+
+    while (F[minidx] == 0 && minidx < 256)
+        minidx++;
+    while (F[maxidx] == 0 && maxidx > 1)
+        maxidx--;
+
+    if (minidx >= maxidx) {
+        mexPrintf("There is <= 1 nonzero pixel intensity\n");
+        result = 128;
+    } else {
+        /* the sums are integers, so the prefix sums are exact */
+        result = maxidx;
+        for (moving = minidx; moving + 1 <= result && moving <= maxidx - 1;
+             moving++) {
+            result = ((S[moving] - S[minidx - 1]) / (C[moving] - C[minidx - 1]) +
+                      (S[maxidx] - S[moving]) / (C[maxidx] - C[moving])) / 2;
+        }
+    }
+
+    /* result >= 0, so this rounds halves up as MATLAB's round does */
+    return 255 - floor(result + 0.5);
+}
+
+//
+// ml_rcthreshold on the histogram of the values 0..nbins-1, ignoring
+// the first and last values
+//
+static double rc_threshold(const double *H, mwSize nbins)
+{
+    double *C = (double *) mxCalloc(nbins, sizeof(double));
+    double *S = (double *) mxCalloc(nbins, sizeof(double));
+    long minidx = 0, maxidx = 0, moving, prev, k;
+
+    for (k = 1; k < (long) nbins; k++) {
+        double h = (k < (long) nbins - 1) ? H[k] : 0.0;
+
+        C[k] = C[k - 1] + h;
+        S[k] = S[k - 1] + k * h;
+        if (h > 0) {
+            if (minidx == 0)
+                minidx = k;
+            maxidx = k;
+        }
+    }
+    if (minidx == 0)
+        minidx = maxidx = 1;
+
+    if (minidx >= maxidx) {
+        mexWarnMsgTxt("There is <= 1 nonzero pixel intensity");
+        moving = minidx;
+    } else {
+        moving = minidx + 1;
+        prev = minidx;
+        while (prev != moving && moving < maxidx) {
+            double loweravg = (S[moving - 1] - S[minidx - 1]) /
+                              (C[moving - 1] - C[minidx - 1]);
+            double higheravg = (S[maxidx] - S[moving - 1]) /
+                               (C[maxidx] - C[moving - 1]);
+
+            prev = moving;
+            moving = (long) ceil((loweravg + higheravg) / 2);
+        }
+    }
+
+    mxFree(C);
+    mxFree(S);
+    return (double) moving;
+}
+
+//
+// ml_kapurthreshold on the values 1..255.  The entropy of p(1:T)/P is
+// log(P) - sum(p.*log(p))/P, so one prefix sum of p.*log(p) serves
+// every T.
+//
+static double kapur_threshold(const double *H)
+{
+    double N = 0.0, C = 0.0, E = 0.0, Etotal = 0.0, best = -1.0;
+    double threshold = -1.0;
+    int T;
+
+    for (T = 1; T < 256; T++) {
+        N += H[T];
+    }
+    if (N == 0)
+        return threshold;
+    for (T = 1; T < 256; T++) {
+        if (H[T] > 0)
+            Etotal += (H[T] / N) * log(H[T] / N);
+    }
+
+    for (T = 1; T < 256; T++) {
+        double P, value;
+
+        C += H[T];
+        if (H[T] > 0)
+            E += (H[T] / N) * log(H[T] / N);
+        if (C == 0)
+            continue;
+        if (C >= N)
+            break;
+
+        P = C / N;
+        value = (log(P) - E / P) + (log(1 - P) - (Etotal - E) / (1 - P));
+        if (value > best) {
+            threshold = T;
+            best = value;
+        }
+    }
+    return threshold;
+}
+
+//
+// ml_yenthreshold on the values 1..255, with the same sums as the
+// MATLAB code
+//
+static double yen_threshold(const double *H)
+{
+    double N = 0.0, C[256], R[256], best = -1.0, threshold = -1.0;
+    int T;
+
+    for (T = 1; T < 256; T++)
+        N += H[T];
+    if (N == 0)
+        return threshold;
+
+    C[0] = R[0] = 0.0;
+    for (T = 1; T < 256; T++) {
+        double p = H[T] / N;
+
+        C[T] = C[T - 1] + H[T];
+        R[T] = R[T - 1] + p * p;
+    }
+
+    for (T = 1; T < 256 && R[T] == 0; T++)
+        ;
+    for (; T < 256 && R[T] < R[255]; T++) {
+        double P = C[T] / N;
+        double value = -log(R[T] / (P * P)) -
+                       log((R[255] - R[T]) / ((1 - P) * (1 - P)));
+
+        if (value > best) {
+            threshold = T;
+            best = value;
+        }
+    }
+    return threshold;
+}
+
+//
+// graythresh on 256 bins, times 255
+//
+static double otsu_threshold(const double *H)
+{
+    double N = 0.0, omega[256], mu[256], maxval = -1.0, idxsum = 0.0;
+    int k, nmax = 0;
+
+    for (k = 0; k < 256; k++)
+        N += H[k];
+    for (k = 0; k < 256; k++) {
+        double p = H[k] / N;
+
+        omega[k] = (k > 0 ? omega[k - 1] : 0.0) + p;
+        mu[k] = (k > 0 ? mu[k - 1] : 0.0) + p * (k + 1);
+    }
+
+    /* NaN (empty classes) never compares equal or greater */
+    for (k = 0; k < 256; k++) {
+        double d = mu[255] * omega[k] - mu[k];
+        double sigma = d * d / (omega[k] * (1 - omega[k]));
+
+        if (sigma > maxval) {
+            maxval = sigma;
+            idxsum = k;
+            nmax = 1;
+        } else if (sigma == maxval) {
+            idxsum += k;
+            nmax++;
+        }
+    }
+
+    if (nmax == 0 || !mxIsFinite(maxval))
+        return 0.0;
+    return idxsum / nmax;
+}
+
+static int method_index(const mxArray *name)
+{
+    char buf[8];
+    int m;
+
+    if (!mxIsChar(name) || mxGetString(name, buf, sizeof(buf)) != 0)
+        mexErrMsgTxt("METHODS must be a method name or a cell array of them.");
+    for (m = 0; m < NMETHODS; m++) {
+        if (strcmp(buf, method_names[m]) == 0)
+            return m;
+    }
+    mexErrMsgTxt("Unknown thresholding method; use 'nih', 'rc', 'kapur', "
+                 "'yen' or 'otsu'.");
+    return -1;
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    int *methods, nmethods = 0, m;
+    double histo256[256], *histo, *thresh;
+    mxArray *histarray;
+    mwSize n, nbins, k;
+    double scale, high = 0.0;
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgTxt("[THRESH, HISTO] = ml_histthresh(IMAGE, METHODS), "
+                     "histogram thresholds of an image.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_histthresh returns at most two outputs.");
+    }
+
+    if (mxGetClassID(prhs[0]) == mxUINT8_CLASS) {
+        nbins = 256;
+        scale = 1.0;
+    } else if (mxGetClassID(prhs[0]) == mxUINT16_CLASS) {
+        nbins = 65536;
+        scale = 257.0;
+    } else {
+        mexErrMsgTxt("IMAGE must be of class uint8 or uint16.");
+        return;
+    }
+
+    if (nrhs < 2) {
+        methods = (int *) mxMalloc(NMETHODS * sizeof(int));
+        for (m = 0; m < NMETHODS; m++)
+            methods[nmethods++] = m;
+    } else if (mxIsCell(prhs[1])) {
+        methods = (int *) mxMalloc((mxGetNumberOfElements(prhs[1]) + 1) *
+                                   sizeof(int));
+        for (k = 0; k < mxGetNumberOfElements(prhs[1]); k++)
+            methods[nmethods++] = method_index(mxGetCell(prhs[1], k));
+    } else {
+        methods = (int *) mxMalloc(sizeof(int));
+        methods[nmethods++] = method_index(prhs[1]);
+    }
+
+    n = mxGetNumberOfElements(prhs[0]);
+    histarray = mxCreateDoubleMatrix(nbins, 1, mxREAL);
+    histo = mxGetPr(histarray);
+    if (nbins == 256)
+        image_histogram((const uint8_T *) mxGetData(prhs[0]), n, nbins, histo);
+    else
+        image_histogram((const uint16_T *) mxGetData(prhs[0]), n, nbins, histo);
+
+    /* the 256 bins of imhist(IMAGE, 256): round(v*255/65535) for uint16 */
+    if (nbins == 256) {
+        memcpy(histo256, histo, sizeof(histo256));
+    } else {
+        memset(histo256, 0, sizeof(histo256));
+        for (k = 0; k < nbins; k++) {
+            histo256[(255 * k + 32767) / 65535] += histo[k];
+            if (k > 255)
+                high += histo[k];
+        }
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(1, nmethods, mxREAL);
+    thresh = mxGetPr(plhs[0]);
+    for (m = 0; m < nmethods; m++) {
+        switch (methods[m]) {
+        case NIH:
+            thresh[m] = scale * nih_threshold(histo256);
+            break;
+        case RC:
+            thresh[m] = rc_threshold(histo, nbins);
+            break;
+        case KAPUR:
+            thresh[m] = (high > 0) ? mxGetNaN() : kapur_threshold(histo);
+            break;
+        case YEN:
+            thresh[m] = (high > 0) ? mxGetNaN() : yen_threshold(histo);
+            break;
+        case OTSU:
+            thresh[m] = scale * otsu_threshold(histo256);
+            break;
+        }
+    }
+
+    mxFree(methods);
+
+    if (nlhs > 1)
+        plhs[1] = histarray;
+    else
+        mxDestroyArray(histarray);
+}
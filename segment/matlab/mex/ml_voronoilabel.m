@@ -0,0 +1,45 @@
+function [L, D] = ml_voronoilabel(SEEDS,CONN,MASK)
+% [L, D] = ML_VORONOILABEL(SEEDS,CONN,MASK) nearest seed labels
+% ML_VORONOILABEL(SEEDS,CONN,MASK),
+%     Labels every pixel of the 2D or 3D label image SEEDS with the
+%     value of its nearest seed, the nonzero pixels of SEEDS, the
+%     distance being the number of CONN-connected steps.  CONN is 4 or
+%     8 in 2D, 6, 18 or 26 in 3D, or a 3x3(x3) logical array; [] or no
+%     CONN gives 8 in 2D and 26 in 3D.  CONN 'euclidean' takes the
+%     Euclidean distance instead.
+%
+%     With a binary MASK the seeds only grow inside MASK, so the
+%     distances are geodesic; the pixels outside MASK or cut off from
+%     every seed get 0.  MASK needs a connectivity.  D is the distance
+%     to the nearest seed (Inf where L is 0).
+%
+%     With a connectivity the labeling is one breadth first search from
+%     all the seeds at once, linear in the number of pixels.  A pixel at
+%     equal distance from two seeds goes to the one whose front reaches
+%     it first, the seeds starting in linear index order.  'euclidean'
+%     is an exact Euclidean feature transform, linear too.  A pixel at
+%     equal distance from two seeds goes to the one with the smaller
+%     linear index.
+%
+%     See also ML_GETVORONOI, WATERSHED_MEYER
+
+% Copyright (C) 2026  Murphy Lab
+% Carnegie Mellon University
+%
+% This program is free software; you can redistribute it and/or modify
+% it under the terms of the GNU General Public License as published
+% by the Free Software Foundation; either version 2 of the License,
+% or (at your option) any later version.
+%
+% This program is distributed in the hope that it will be useful, but
+% WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% General Public License for more details.
+%
+% You should have received a copy of the GNU General Public License
+% along with this program; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+% 02110-1301, USA.
+%
+% For additional information visit http://murphylab.web.cmu.edu or
+% send email to murphy@cmu.edu
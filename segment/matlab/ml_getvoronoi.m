@@ -13,36 +13,37 @@ newIm = zeros([nrows,ncols]);
 bwl = bwlabel(nuclei_mask,conn);
 stats = regionprops(bwl,'Centroid');%'Eccentricity','ConvexArea','Area');
 
-NDIMS = 2;
-objCofs = zeros(NDIMS,length(stats));
-if length(stats)>1
-    for i=1:length(stats)
-        objCofs(:,i)=stats(i).Centroid';
-    end
-else
+if length(stats)<=1
 % if only one Centroid, return entire image as mask
     cells_mask=newIm;
     return
 end
-    
-
-% Compute Voronoi diagram
-[vx, vy] = voronoi( objCofs(2,:), objCofs(1,:), {'QJ'} );
-vx = round(vx);
-vy = round(vy);
-
 
-vx = [vx [1 1; 1 nrows; nrows nrows; nrows 1]'];
-vy = [vy [1 ncols; ncols ncols; ncols 1; 1 1]'];
-
-% Connect all the vertices of the Voronoi diagram
-for i = 1:size(vx,2)
-    pts = ml_getlinepts(round([vx(1,i) vy(1,i)]),round([vx(2,i) vy(2,i)]));
-    ng = sum(pts<=0,2)+(pts(:,1)>size(newIm,1))+(pts(:,2)>size(newIm,2));
-    pts(ng>0,:) = [];
-    
-    newIm(pts(:,1) + (pts(:,2)-1)*nrows) = 1;
+% Voronoi diagram of the nucleus centroids: label every pixel with its
+% nearest centroid, rounded to a pixel, in Euclidean distance
+% (ml_voronoilabel, exact and linear in the number of pixels).  A pixel
+% at equal distance from two centroids goes to the one with the smaller
+% linear index, the leftmost, then the upper.  Then draw the borders
+% between the regions and around the image.  Rounding the centroids
+% moves the edges slightly from those of VORONOI on the exact ones.
+% Two centroids rounded to the same pixel keep the first one; the
+% other nucleus then gets no cell of its own.
+seeds = zeros([nrows,ncols]);
+for i=1:length(stats)
+    c = round(stats(i).Centroid);
+    if seeds(c(2),c(1)) ~= 0
+        warning('ml_getvoronoi:sharedCentroid', ...
+                'Nuclei %d and %d have their centroids in the same pixel; nucleus %d gets no cell.', ...
+                seeds(c(2),c(1)), i, i);
+        continue
+    end
+    seeds(c(2),c(1)) = i;
 end
+L = ml_voronoilabel(seeds,'euclidean');
+newIm(1:end-1,:) = L(1:end-1,:)~=L(2:end,:);
+newIm(:,1:end-1) = newIm(:,1:end-1) | (L(:,1:end-1)~=L(:,2:end));
+newIm([1 end],:) = 1;
+newIm(:,[1 end]) = 1;
 
 segLabel = bwlabel(~newIm,conn);
 % figure,imshow(newIm,[]),title('newIm')
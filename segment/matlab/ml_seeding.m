@@ -86,7 +86,8 @@ if seeding.withWatershed==1
     imComplement = uint8(imcomplement(nuclei_mask));
     distImg =  uint8(bwdist(imComplement));
     imComplement2 =  uint8(imcomplement(distImg));
-    cellImg = watershed(imComplement2);
+    % the regional minima are found and flooded in the same MEX call
+    cellImg = watershed_meyer(imComplement2, 8, 0);
     nuclei_mask(find(cellImg==0))=0;
 
 
@@ -70,7 +70,7 @@ obj_sizes=[];
 objx=[];
 objy=[];
 objCofsAll=[];
-[img_moment00, img_moment10, img_moment01, obj_size] = ml_moments_1(int32(dna),int32(imagelabeled));
+[img_moment00, img_moment10, img_moment01, obj_size] = ml_moments_1(int32(dna),int32(imagelabeled),obj_number);
 
 for (i=1:obj_number)
         obj_sizes(i) = obj_size(i+1);
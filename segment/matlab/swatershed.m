@@ -1,9 +1,18 @@
-function L = swatershed(A,seeds,conn)
-% L = SWATERSHED(A,SEEDS,CONN)
+function [L,RAG] = swatershed(A,seeds,conn,compactness,lines)
+% [L,RAG] = SWATERSHED(A,SEEDS,CONN,COMPACTNESS,LINES)
 % L is the output, watershed image regions (type double)
+% RAG (optional) is the region adjacency graph, one row
+%   [LABEL1 LABEL2 BOUNDARYLENGTH MINSADDLE MEANSADDLE] per pair of
+%   adjacent regions, LABEL1 < LABEL2, collected while flooding
 % A is the input gray level image (type uint16)
-% SEEDS is the seed channel, a binary image)
+% SEEDS is the seed channel, a binary image), or a scalar H to seed
+%   from the h-minima of A (imextendedmin(A,H)), found in the MEX
 % CONN is the connectivity, by default 8 for 2D, 26 for 3D
+% COMPACTNESS (optional) adds COMPACTNESS times the distance in pixels to
+%   the seed to the flooding priority, which gives regular, compact
+%   regions (compact watershed).
+% LINES (optional, default true) false gives regions without the 0-valued
+%   watershed lines between them.
 
 if ~exist( 'conn','var')
     if ndims(A)==2
@@ -16,9 +25,21 @@ if ~exist( 'conn','var')
     end
 end
 
-if size(A)~=size(seeds)
+if isscalar(seeds) && ~isscalar(A)
+    M = seeds;
+elseif size(A)~=size(seeds)
     error( 'Inputs are not compatible');
+else
+    M = bwlabeln( seeds,conn);
+end
+if ~exist('compactness','var')
+    compactness = 0;
+end
+if ~exist('lines','var')
+    lines = true;
+end
+if nargout > 1
+    [L,RAG] = watershed_meyer(A,conn,M,'double',compactness,lines);
+else
+    L = watershed_meyer(A,conn,M,'double',compactness,lines);
 end
-
-M = bwlabeln( seeds,conn);
-L = watershed_meyer(A,conn,M);
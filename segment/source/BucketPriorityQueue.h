@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+#ifndef BucketPriorityQueue_H
+#define BucketPriorityQueue_H
+
+#include <vector>
+
+#include "mex.h"
+
+/** BucketPriorityQueue
+ *  A lowest-priority-first queue for small integer priorities, with the
+ *  interface and the FIFO behavior of FifoPriorityQueue: items of equal
+ *  priority are returned in the order they were pushed.
+ *
+ *  Each priority level 0..num_levels-1 has its own FIFO, so push() and
+ *  pop() take constant time instead of the O(log n) heap operations and
+ *  comparator calls of FifoPriorityQueue.  A two-level bitmap of the
+ *  non-empty levels finds the next level to serve with two word scans,
+ *  even among the 65536 levels of a uint16 image.
+ *
+ *  @see FifoPriorityQueue
+ */
+template <typename DATA_T, typename PRIORITY_T>
+class BucketPriorityQueue
+{
+  public:
+    /** BucketPriorityQueue
+     *  Class constructor.
+     *
+     *  @param num_levels   int, priorities must lie in 0..num_levels-1
+     */
+    BucketPriorityQueue(int num_levels) :
+        fNumLevels(num_levels),
+        fFifos(num_levels),
+        fHeads(num_levels, 0),
+        fLevelBits((num_levels + 63) / 64, 0),
+        fWordBits((num_levels + 64 * 64 - 1) / (64 * 64), 0),
+        fTop(num_levels),
+        fSize(0) {
+    }
+
+    /** push
+     *  Push a data value and an associated priority value onto the queue.
+     *
+     *  @param data         DATA_T
+     *  @param priority     PRIORITY_T
+     */
+    void push(DATA_T data, PRIORITY_T priority) {
+        int level = (int) priority;
+
+        if (fHeads[level] == fFifos[level].size()) {
+            setLevel(level);
+        }
+        fFifos[level].push_back(data);
+        if (level < fTop) {
+            fTop = level;
+        }
+        fSize++;
+    }
+
+    /** topData
+     *  Get the data value associated with top item on the queue.  This does
+     *  not modify the queue.
+     *
+     *  @return DATA_T
+     */
+    DATA_T topData(void) {
+        return fFifos[fTop][fHeads[fTop]];
+    }
+
+    /** topPriority
+     *  Get the priority value associated with top item on the queue.  This does
+     *  not modify the queue.
+     *
+     *  @return PRIORITY_T
+     */
+    PRIORITY_T topPriority(void) {
+        return (PRIORITY_T) fTop;
+    }
+
+    /** pop
+     *  Remove the top item from the queue.  An emptied level keeps its
+     *  storage for later pushes.
+     */
+    void pop(void) {
+        if (++fHeads[fTop] == fFifos[fTop].size()) {
+            fFifos[fTop].clear();
+            fHeads[fTop] = 0;
+            clearLevel(fTop);
+            fTop = nextLevel(fTop);
+        }
+        fSize--;
+    }
+
+    /** isEmpty
+     *  Tests whether the queue is empty.
+     *
+     *  @return    bool
+     */
+    bool    isEmpty(void) {
+        return fSize == 0;
+    }
+
+  private:
+    int fNumLevels;                           /**< Number of priority levels. */
+    std::vector<std::vector<DATA_T> > fFifos; /**< One FIFO per level. */
+    std::vector<size_t> fHeads;               /**< Read position of each FIFO. */
+    std::vector<uint64_T> fLevelBits;         /**< Bit l set if level l is non-empty. */
+    std::vector<uint64_T> fWordBits;          /**< Bit w set if fLevelBits[w] != 0. */
+    int fTop;                                 /**< Lowest non-empty level, or fNumLevels. */
+    size_t fSize;                             /**< Number of queued items. */
+
+    /** firstBit
+     *  Index of the lowest set bit of a nonzero word.
+     */
+    static int firstBit(uint64_T bits) {
+#ifdef __GNUC__
+        return __builtin_ctzll(bits);
+#else
+        int k = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            k++;
+        }
+        return k;
+#endif
+    }
+
+    void setLevel(int level) {
+        fLevelBits[level >> 6] |= (uint64_T) 1 << (level & 63);
+        fWordBits[level >> 12] |= (uint64_T) 1 << ((level >> 6) & 63);
+    }
+
+    void clearLevel(int level) {
+        int w = level >> 6;
+
+        fLevelBits[w] &= ~((uint64_T) 1 << (level & 63));
+        if (fLevelBits[w] == 0) {
+            fWordBits[w >> 6] &= ~((uint64_T) 1 << (w & 63));
+        }
+    }
+
+    /** nextLevel
+     *  Lowest non-empty level above LEVEL, or fNumLevels.
+     */
+    int nextLevel(int level) {
+        int w = level >> 6;
+        uint64_T bits = fLevelBits[w] & (~(uint64_T) 0 << (level & 63));
+
+        if (bits) {
+            return (w << 6) + firstBit(bits);
+        }
+
+        /* the first non-empty word after w, from the word bitmap */
+        w++;
+        int h = w >> 6;
+        if (h >= (int) fWordBits.size()) {
+            return fNumLevels;
+        }
+        bits = fWordBits[h] & (~(uint64_T) 0 << (w & 63));
+        while (!bits) {
+            if (++h >= (int) fWordBits.size()) {
+                return fNumLevels;
+            }
+            bits = fWordBits[h];
+        }
+        w = (h << 6) + firstBit(bits);
+        return (w << 6) + firstBit(fLevelBits[w]);
+    }
+};
+
+#endif // BucketPriorityQueue_H
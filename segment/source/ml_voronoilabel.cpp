@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2026 Murphy Lab,Carnegie Mellon University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * For additional information visit http://murphylab.web.cmu.edu or
+ * send email to murphy@cmu.edu
+ */
+
+/*/////////////////////////////////////////////////////////////////////////
+//
+//                          ml_voronoilabel.cpp
+//
+//  Labels every pixel of a 2D or 3D image with its nearest seed region.
+//
+//  [L, D] = ml_voronoilabel(SEEDS, CONN, MASK)
+//  where:
+//     -SEEDS is a label image (double, int32, uint16, uint8 or logical)
+//      whose nonzero pixels are the seeds
+//     -CONN is the connectivity, as for watershed_meyer: 4 or 8 in 2D,
+//      6, 18 or 26 in 3D, or a 3x3(x3) logical array.  [] or no CONN
+//      means 8 in 2D and 26 in 3D.  'euclidean' measures the Euclidean
+//      distance instead.
+//     -MASK (optional) is a binary image with size==SEEDS.  The seeds
+//      then only grow inside MASK: distances are geodesic, and the
+//      pixels outside MASK or cut off from every seed get 0.  It needs
+//      a connectivity.
+//     -L is the value of SEEDS at the nearest seed pixel (double)
+//     -D (optional) is the number of CONN steps to it, or the Euclidean
+//      distance, Inf where L is 0
+//
+//  With a connectivity, multi-source breadth first search from all the
+//  seed pixels at once, with the neighbor offsets and border map of
+//  watershed_meyer.  Every pixel is queued once, so the time is linear
+//  in the number of pixels.  A pixel at equal distance from two seeds
+//  goes to the front that reaches it first, the seeds being queued in
+//  linear index order.
+//
+//  'euclidean' is the exact Euclidean feature transform of Felzenszwalb
+//  and Huttenlocher: the squared distance to the nearest seed, and that
+//  seed, are found along the first dimension, then along the second
+//  from the first's, and so on; linear time too.  A pixel at equal
+//  distance from two seeds goes to the one with the smaller linear
+//  index.
+//
+/////////////////////////////////////////////////////////////////////////*/
+
+#include "mex.h"
+#include "matrix.h"
+#include "neighborhood.h"
+#include <math.h>
+#include <string.h>
+
+//
+// Nearest seeds along one line of n pixels, stride apart.  f holds the
+// squared distances found so far and nearest their seeds (-1 and Inf
+// where there is none); both are updated to the minimum over the line
+// of (x - q)^2 + f[q].  v, zn, zd, g and h are scratch of n elements.
+// The envelope of the parabolas is kept in exact integer arithmetic,
+// its k-th parabola v[k] starting at zn[k]/zd[k], so that at equal
+// distance the seed found from the smaller q, and so the smaller linear
+// index, is kept.
+//
+static void edt_line(int n, int stride, double *f, int32_T *nearest,
+                     int *v, int64_T *zn, int64_T *zd, double *g,
+                     int32_T *h)
+{
+    int q, x, j, k = -1;
+
+    for (x = 0; x < n; x++) {
+        g[x] = f[(size_t) x * stride];
+        h[x] = nearest[(size_t) x * stride];
+    }
+
+    for (q = 0; q < n; q++) {
+        int64_T Fq, num = 0, den = 1;
+
+        if (h[q] < 0)
+            continue;
+        Fq = (int64_T) g[q] + (int64_T) q * q;
+
+        /* drop the parabolas q hides, those beaten or tied from where
+           they start */
+        while (k >= 0) {
+            num = Fq - ((int64_T) g[v[k]] + (int64_T) v[k] * v[k]);
+            den = 2 * (int64_T) (q - v[k]);
+            if (k > 0 && num * zd[k] <= zn[k] * den)
+                k--;
+            else
+                break;
+        }
+        k++;
+        v[k] = q;
+        zn[k] = num;
+        zd[k] = den;
+    }
+
+    if (k < 0)
+        return;
+    for (x = 0, j = 0; x < n; x++) {
+        while (j < k && zn[j + 1] < (int64_T) x * zd[j + 1])
+            j++;
+        f[(size_t) x * stride] = (double) (x - v[j]) * (x - v[j]) + g[v[j]];
+        nearest[(size_t) x * stride] = h[v[j]];
+    }
+}
+
+//
+// Euclidean nearest seeds.  L holds the seed values on entry.
+//
+static void voronoi_edt(const int *dims, int ndims, int N, double *L,
+                        double *D)
+{
+    double *f, *g;
+    int32_T *nearest, *h;
+    int64_T *zn, *zd;
+    int *v;
+    int stride = 1, longest = 1;
+    int d, p;
+
+    for (d = 0; d < ndims; d++)
+        if (dims[d] > longest)
+            longest = dims[d];
+
+    f = (D != NULL) ? D : (double *) mxMalloc(N * sizeof(double) + 1);
+    nearest = (int32_T *) mxMalloc(N * sizeof(int32_T) + 1);
+    g = (double *) mxMalloc(longest * sizeof(double));
+    h = (int32_T *) mxMalloc(longest * sizeof(int32_T));
+    zn = (int64_T *) mxMalloc(longest * sizeof(int64_T));
+    zd = (int64_T *) mxMalloc(longest * sizeof(int64_T));
+    v = (int *) mxMalloc(longest * sizeof(int));
+
+    for (p = 0; p < N; p++) {
+        f[p] = (L[p] != 0.0) ? 0.0 : mxGetInf();
+        nearest[p] = (L[p] != 0.0) ? p : -1;
+    }
+
+    /* the lines along dimension d start at the pixels with coordinate 0
+       along it */
+    for (d = 0; d < ndims; d++) {
+        int n = dims[d], a, b;
+
+        for (b = 0; b < N; b += stride * n) {
+            for (a = 0; a < stride; a++) {
+                edt_line(n, stride, f + b + a, nearest + b + a, v, zn, zd,
+                         g, h);
+            }
+        }
+        stride *= n;
+    }
+
+    /* the seeds keep their values, so L can be read in place */
+    for (p = 0; p < N; p++) {
+        L[p] = (nearest[p] >= 0) ? L[nearest[p]] : 0.0;
+        if (D != NULL)
+            D[p] = sqrt(f[p]);
+    }
+
+    mxFree(v);
+    mxFree(zd);
+    mxFree(zn);
+    mxFree(h);
+    mxFree(g);
+    mxFree(nearest);
+    if (f != D)
+        mxFree(f);
+}
+
+template<typename S_T>
+static void read_seeds(const S_T *S, int N, double *L)
+{
+    int p;
+
+    for (p = 0; p < N; p++)
+        L[p] = (double) S[p];
+}
+
+template<typename M_T>
+static void read_mask(const M_T *M, int N, bool *done)
+{
+    int p;
+
+    for (p = 0; p < N; p++)
+        done[p] = (M[p] == 0);
+}
+
+//
+// The pixels with done[p] set on entry are never entered.  D may be NULL.
+//
+static void voronoi_bfs(Neighborhood_T nhood, const int *dims, int ndims,
+                        int N, bool *done, double *L, double *D)
+{
+    NeighborhoodWalker_T walker;
+    uint32_T *border;
+    int32_T *offsets, *neighbors, *queue;
+    int32_T num_offsets;
+    int head = 0, tail = 0;
+    int p, k;
+
+    walker = nhMakeNeighborhoodWalker(nhood, dims, ndims, NH_SKIP_CENTER);
+    border = (uint32_T *) mxMalloc(((N + 31) / 32) * sizeof(uint32_T) + 1);
+    offsets = (int32_T *) mxMalloc((nhGetNumNeighbors(walker) + 1) *
+                                   sizeof(int32_T));
+    neighbors = (int32_T *) mxMalloc((nhGetNumNeighbors(walker) + 1) *
+                                     sizeof(int32_T));
+    queue = (int32_T *) mxMalloc(N * sizeof(int32_T) + 1);
+    nhMarkBorderPixels(walker, border);
+    num_offsets = nhGetUsedNeighborOffsets(walker, offsets);
+
+    /* the seeds grow even if they lie outside the mask */
+    for (p = 0; p < N; p++) {
+        if (L[p] != 0.0) {
+            done[p] = true;
+            queue[tail++] = p;
+        }
+        if (D != NULL)
+            D[p] = (L[p] != 0.0) ? 0.0 : mxGetInf();
+    }
+
+    while (head < tail) {
+        int num;
+
+        p = queue[head++];
+        num = nhGetNeighbors(walker, offsets, num_offsets, border, p,
+                             neighbors);
+        for (k = 0; k < num; k++) {
+            int q = neighbors[k];
+
+            if (!done[q]) {
+                done[q] = true;
+                L[q] = L[p];
+                if (D != NULL)
+                    D[q] = D[p] + 1.0;
+                queue[tail++] = q;
+            }
+        }
+    }
+
+    mxFree(queue);
+    mxFree(neighbors);
+    mxFree(offsets);
+    mxFree(border);
+    nhDestroyNeighborhoodWalker(walker);
+}
+
+extern "C"
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    const int *dims;
+    int ndims, N;
+    Neighborhood_T nhood;
+    double *L, *D = NULL;
+    bool *done, euclidean;
+    void *S;
+
+    if (nrhs < 1 || nrhs > 3) {
+        mexErrMsgTxt("[L, D] = ml_voronoilabel(SEEDS, CONN, MASK), nearest "
+                     "seed labels.");
+    } else if (nlhs > 2) {
+        mexErrMsgTxt("ml_voronoilabel returns at most two outputs.");
+    }
+
+    ndims = mxGetNumberOfDimensions(prhs[0]);
+    if ((!mxIsNumeric(prhs[0]) && !mxIsLogical(prhs[0])) ||
+        mxIsComplex(prhs[0]) || ndims > 3) {
+        mexErrMsgTxt("SEEDS must be a real 2D or 3D matrix.");
+    }
+    euclidean = (nrhs >= 2 && mxIsChar(prhs[1]));
+    if (euclidean) {
+        char name[10];
+
+        if (mxGetString(prhs[1], name, sizeof(name)) != 0 ||
+            strcmp(name, "euclidean") != 0) {
+            mexErrMsgTxt("CONN must be a connectivity or 'euclidean'.");
+        } else if (nrhs == 3) {
+            mexErrMsgTxt("MASK needs a connectivity, not 'euclidean'.");
+        }
+    }
+    if (nrhs == 3 &&
+        (mxGetNumberOfDimensions(prhs[2]) != ndims ||
+         memcmp(mxGetDimensions(prhs[2]), mxGetDimensions(prhs[0]),
+                ndims * sizeof(int)) != 0)) {
+        mexErrMsgTxt("MASK must be the same size as SEEDS.");
+    }
+
+    dims = mxGetDimensions(prhs[0]);
+    N = mxGetNumberOfElements(prhs[0]);
+
+    plhs[0] = mxCreateNumericArray(ndims, dims, mxDOUBLE_CLASS, mxREAL);
+    L = mxGetPr(plhs[0]);
+    if (nlhs > 1) {
+        plhs[1] = mxCreateNumericArray(ndims, dims, mxDOUBLE_CLASS, mxREAL);
+        D = mxGetPr(plhs[1]);
+    }
+
+    S = mxGetData(prhs[0]);
+    switch (mxGetClassID(prhs[0])) {
+    case mxDOUBLE_CLASS:
+        read_seeds((const double *) S, N, L);
+        break;
+    case mxINT32_CLASS:
+        read_seeds((const int32_T *) S, N, L);
+        break;
+    case mxUINT16_CLASS:
+        read_seeds((const uint16_T *) S, N, L);
+        break;
+    case mxUINT8_CLASS:
+        read_seeds((const uint8_T *) S, N, L);
+        break;
+    case mxLOGICAL_CLASS:
+        read_seeds((const mxLogical *) S, N, L);
+        break;
+    default:
+        mexErrMsgTxt("SEEDS must be of class double, int32, uint16, uint8 "
+                     "or logical.");
+    }
+
+    if (euclidean) {
+        voronoi_edt(dims, ndims, N, L, D);
+        return;
+    }
+
+    done = (bool *) mxCalloc(N + 1, sizeof(bool));
+    if (nrhs == 3) {
+        void *M = mxGetData(prhs[2]);
+
+        switch (mxGetClassID(prhs[2])) {
+        case mxDOUBLE_CLASS:
+            read_mask((const double *) M, N, done);
+            break;
+        case mxUINT8_CLASS:
+            read_mask((const uint8_T *) M, N, done);
+            break;
+        case mxLOGICAL_CLASS:
+            read_mask((const mxLogical *) M, N, done);
+            break;
+        default:
+            mexErrMsgTxt("MASK must be of class logical, uint8 or double.");
+        }
+    }
+
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1]))
+        nhood = nhMakeNeighborhood(prhs[1], NH_CENTER_MIDDLE_ROUNDDOWN);
+    else
+        nhood = nhMakeDefaultConnectivityNeighborhood(ndims);
+
+    voronoi_bfs(nhood, dims, ndims, N, done, L, D);
+
+    nhDestroyNeighborhood(nhood);
+    mxFree(done);
+}
@@ -1320,3 +1320,148 @@ void nhDestroyNeighborhoodWalker(NeighborhoodWalker_T walker)
     mxFree(walker);
 }
 
+
+/*
+ * nhGetUsedNeighborOffsets
+ * Get the linear offsets of the neighbors a walk visits (those not
+ * filtered out by the walker flags), in walk order.
+ *
+ * Inputs
+ * ======
+ * walker  - NeighborhoodWalker_T object
+ *
+ * Output
+ * ======
+ * offsets - array of at least nhGetNumNeighbors(walker) elements
+ *
+ * Return
+ * ======
+ * number of offsets written
+ */
+int32_T nhGetUsedNeighborOffsets(NeighborhoodWalker_T walker,
+                                 int32_T *offsets)
+{
+    int32_T count = 0;
+    int k;
+
+    mxAssert(walker != NULL, "");
+    mxAssert(offsets != NULL, "");
+
+    for (k = 0; k < walker->num_neighbors; k++)
+    {
+        if (walker->use[k])
+        {
+            offsets[count++] = walker->neighbor_offsets[k];
+        }
+    }
+
+    return count;
+}
+
+/*
+ * nhMarkBorderPixels
+ * Flag the pixels that have at least one used neighbor outside the
+ * image.  For the other (interior) pixels p, the walk visits exactly
+ * p + offsets[k] for the offsets returned by nhGetUsedNeighborOffsets,
+ * so the walker and its bounds checks can be skipped.
+ *
+ * The image is scanned one column (first dimension) at a time with
+ * the higher coordinates kept as a counter; no divisions are needed.
+ *
+ * Inputs
+ * ======
+ * walker - NeighborhoodWalker_T object
+ *
+ * Output
+ * ======
+ * border - one bit per image pixel, bit p%32 of word p/32 for pixel p;
+ *          (num_elements + 31)/32 words
+ */
+void nhMarkBorderPixels(NeighborhoodWalker_T walker, uint32_T *border)
+{
+    int num_dims = walker->num_dims;
+    int num_elements = walker->cumprod[num_dims];
+    int rows = walker->image_size[0];
+    int *lo;
+    int *hi;
+    int *coords;
+    int c;
+    int k;
+    int p;
+    int r;
+
+    mxAssert(walker != NULL, "");
+    mxAssert(border != NULL, "");
+
+    /*
+     * Along dimension k a pixel is interior if lo[k] <= coords[k] and
+     * coords[k] < image_size[k] - hi[k].
+     */
+    lo = (int *) mxCalloc(num_dims, sizeof(*lo));
+    hi = (int *) mxCalloc(num_dims, sizeof(*hi));
+    coords = (int *) mxCalloc(num_dims, sizeof(*coords));
+    for (k = 0; k < walker->num_neighbors; k++)
+    {
+        if (walker->use[k])
+        {
+            for (c = 0; c < num_dims; c++)
+            {
+                int offset = walker->array_coords[k*num_dims + c];
+
+                if (-offset > lo[c])
+                {
+                    lo[c] = -offset;
+                }
+                if (offset > hi[c])
+                {
+                    hi[c] = offset;
+                }
+            }
+        }
+    }
+
+    for (p = 0; p < (num_elements + 31) / 32; p++)
+    {
+        border[p] = 0;
+    }
+
+    for (p = 0; p < num_elements; p += rows)
+    {
+        bool column_border = false;
+
+        for (c = 1; c < num_dims; c++)
+        {
+            if ((coords[c] < lo[c]) ||
+                (coords[c] >= walker->image_size[c] - hi[c]))
+            {
+                column_border = true;
+            }
+        }
+
+        for (r = 0; r < rows; r++)
+        {
+            if (column_border || (r < lo[0]) || (r >= rows - hi[0]))
+            {
+                border[(p + r) >> 5] |= 1u << ((p + r) & 31);
+            }
+            else if (r < rows - hi[0] - 1)
+            {
+                /* Skip to the bottom border of the column */
+                r = rows - hi[0] - 1;
+            }
+        }
+
+        for (c = 1; c < num_dims; c++)
+        {
+            if (++coords[c] < walker->image_size[c])
+            {
+                break;
+            }
+            coords[c] = 0;
+        }
+    }
+
+    mxFree(lo);
+    mxFree(hi);
+    mxFree(coords);
+}
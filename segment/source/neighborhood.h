@@ -103,6 +103,42 @@ int32_T *nhGetWalkerNeighborOffsets(NeighborhoodWalker_T walker);
 int num_nonzeros(const mxArray *D);
 Neighborhood_T allocate_neighborhood(int num_neighbors, int num_dims);
 int32_T nhGetNumNeighbors(NeighborhoodWalker_T walker);
+int32_T nhGetUsedNeighborOffsets(NeighborhoodWalker_T walker,
+                                 int32_T *offsets);
+void nhMarkBorderPixels(NeighborhoodWalker_T walker, uint32_T *border);
+
+/*
+ * nhGetNeighbors
+ * Linear indices of the inbounds neighbors of pixel p, in walk order.
+ * Interior pixels (bit p of border clear, see nhMarkBorderPixels) add the
+ * offsets from nhGetUsedNeighborOffsets; border pixels use the walker.
+ * neighbors must hold num_offsets elements.  Returns their number.
+ */
+inline int32_T nhGetNeighbors(NeighborhoodWalker_T walker,
+                              const int32_T *offsets, int32_T num_offsets,
+                              const uint32_T *border, int p,
+                              int32_T *neighbors)
+{
+    int32_T count = 0;
+
+    if (!((border[p >> 5] >> (p & 31)) & 1u))
+    {
+        for (; count < num_offsets; count++)
+        {
+            neighbors[count] = p + offsets[count];
+        }
+    }
+    else
+    {
+        nhSetWalkerLocation(walker, p);
+        while (nhGetNextInboundsNeighbor(walker, neighbors + count, NULL))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
 
 /////////////////////////////////////////////////////////////////////////
 //
@@ -1,8 +1,17 @@
 // Copyright 2006 The MathWorks, Inc.
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "mex.h"
 #include "neighborhood.h"
 #include "FifoPriorityQueue.h"
+#include "BucketPriorityQueue.h"
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -21,6 +30,143 @@ inline void do_nan_check(_T *F,int num_elements)
     }
 }     
 
+//////////////////////////////////////////////////////////////////////////////
+// Neighbors of the pixels of one image or block: the walker for the
+// border pixels, the linear offsets for the interior ones.  border has
+// one bit per pixel.
+//////////////////////////////////////////////////////////////////////////////
+struct Neighbors
+{
+    NeighborhoodWalker_T walker;
+    uint32_T *border;
+    int32_T *offsets;
+    int32_T  num_offsets;
+};
+
+void make_neighbors(Neighborhood_T nhood, const int *size, int num_dims,
+                    Neighbors &nb)
+{
+    int N = 1;
+    for (int k = 0; k < num_dims; k++)
+    {
+        N *= size[k];
+    }
+
+    nb.walker = nhMakeNeighborhoodWalker(nhood, size, num_dims, NH_SKIP_CENTER);
+    nb.border = new uint32_T[(N + 31) / 32];
+    nhMarkBorderPixels(nb.walker, nb.border);
+    nb.offsets = new int32_T[nhGetNumNeighbors(nb.walker)];
+    nb.num_offsets = nhGetUsedNeighborOffsets(nb.walker, nb.offsets);
+}
+
+void destroy_neighbors(Neighbors &nb)
+{
+    nhDestroyNeighborhoodWalker(nb.walker);
+    delete[] nb.border;
+    delete[] nb.offsets;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// One bit per pixel, set once the pixel has been pushed.
+//////////////////////////////////////////////////////////////////////////////
+inline uint32_T *new_bits(int N)
+{
+    int num_words = (N + 31) / 32;
+    uint32_T *bits = new uint32_T[num_words];
+    std::fill(bits, bits + num_words, 0u);
+    return bits;
+}
+
+inline bool test_bit(const uint32_T *bits, int p)
+{
+    return ((bits[p >> 5] >> (p & 31)) & 1u) != 0;
+}
+
+inline void set_bit(uint32_T *bits, int p)
+{
+    bits[p >> 5] |= 1u << (p & 31);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// The label a pixel gets from its labeled neighbors, WSHED if it has
+// none.  Returns true if they disagree, making it a watershed pixel.
+//////////////////////////////////////////////////////////////////////////////
+inline bool is_watershed(const int32_T *L, const int32_T *neighbors, int num,
+                         int32_T &label)
+{
+    const int32_T WSHED = 0;
+
+    label = WSHED;
+    for (int k = 0; k < num; k++)
+    {
+        int32_T l = L[neighbors[k]];
+        if (l != WSHED)
+        {
+            if ((label != WSHED) && (l != label))
+            {
+                return true;
+            }
+            label = l;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Where two basins meet: their labels a < b and the flooding level v.
+//////////////////////////////////////////////////////////////////////////////
+struct Contact
+{
+    int32_T a;
+    int32_T b;
+    double  v;
+};
+
+inline bool operator<(const Contact &x, const Contact &y)
+{
+    return (x.a < y.a) || ((x.a == y.a) && (x.b < y.b));
+}
+
+inline void add_contact(std::vector<Contact> *contacts, int32_T a, int32_T b,
+                        double v)
+{
+    Contact c;
+    c.a = std::min(a, b);
+    c.b = std::max(a, b);
+    c.v = v;
+    contacts->push_back(c);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// A watershed pixel flooded at level v is a contact between every two
+// distinct labels among its neighbors.  labels is scratch space for num
+// labels.
+//////////////////////////////////////////////////////////////////////////////
+inline void add_watershed_contacts(const int32_T *L, const int32_T *neighbors,
+                                   int num, double v, int32_T *labels,
+                                   std::vector<Contact> *contacts)
+{
+    int num_labels = 0;
+    for (int k = 0; k < num; k++)
+    {
+        int32_T l = L[neighbors[k]];
+        if ((l != 0) &&
+            (std::find(labels, labels + num_labels, l) == labels + num_labels))
+        {
+            labels[num_labels++] = l;
+        }
+    }
+
+    for (int i = 0; i < num_labels; i++)
+    {
+        for (int j = i + 1; j < num_labels; j++)
+        {
+            add_contact(contacts, labels[i], labels[j], v);
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Algorithm reference: F. Meyer, "Topographic distance and watershed lines,"
 // Signal Processing, 38:113-125, 1994.  Implemented using the description
@@ -29,83 +175,621 @@ inline void do_nan_check(_T *F,int num_elements)
 // www.insight-journal.org, downloaded 7-Jul-2006.
 //////////////////////////////////////////////////////////////////////////////
 
-template<typename _T>
-void compute_watershed(_T *I, double *M, int N, NeighborhoodWalker_T walker,
-                       double *L)
+//
+// L holds the markers on entry.  Without lines a pixel takes the label
+// of the pixel that pushed it.  If contacts is not NULL, every meeting
+// of two basins is added to it: a watershed pixel between them or, without
+// lines, a pair of neighbors in different basins.
+//
+template<typename _T, typename _Q>
+void compute_watershed(_T *I, int N, Neighbors &nb, int32_T *L, _Q &queue,
+                       bool lines, std::vector<Contact> *contacts)
 {
-    FifoPriorityQueue<int, _T> queue(FifoPriorityItemCompareFcn<int, _T>::LowestPriorityFirst);
-
-    bool *S = new bool[N];
-    for (int p = 0; p < N; p++)
+    uint32_T *S = new_bits(N);
+    int32_T *neighbors = new int32_T[nhGetNumNeighbors(nb.walker)];
+    int32_T *labels = new int32_T[nhGetNumNeighbors(nb.walker)];
+    std::vector<std::pair<int, int32_T> > first_labels;
+    
+    // Without lines, the pixels already flooded; their labels are final.
+    uint32_T *F = NULL;
+    if (!lines && (contacts != NULL))
     {
-        S[p] = false;
+        F = new_bits(N);
     }
-    
-    const double WSHED = 0.0;
+
+    const int32_T WSHED = 0;
 
     for (int p = 0; p < N; p++)
     {
-        L[p] = M[p];
-        if (M[p] != WSHED)
+        if (L[p] != WSHED)
         {
-            int q;
-            S[p] = true;
-            nhSetWalkerLocation(walker, p);
-            while (nhGetNextInboundsNeighbor(walker, &q, NULL))
+            set_bit(S, p);
+            int num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                     nb.border, p, neighbors);
+            for (int k = 0; k < num; k++)
             {
-                if ( (! S[q]) && (M[q] == WSHED) )
+                int q = neighbors[k];
+                if ( (! test_bit(S, q)) && (L[q] == WSHED) )
                 {
-                    S[q] = true;
+                    set_bit(S, q);
                     queue.push(q, I[q]);
+                    if (!lines)
+                    {
+                        first_labels.push_back(std::make_pair(q, L[p]));
+                    }
+                }
+                else if ((F != NULL) && (q < p) && (L[q] != WSHED) &&
+                         (L[q] != L[p]))
+                {
+                    add_contact(contacts, L[p], L[q],
+                                (double) std::max(I[p], I[q]));
                 }
             }
+            if (F != NULL)
+            {
+                set_bit(F, p);
+            }
         }
     }
+    for (size_t j = 0; j < first_labels.size(); j++)
+    {
+        L[first_labels[j].first] = first_labels[j].second;
+    }
 
     while (! queue.isEmpty() )
     {
-        int q;
         int p = queue.topData();
         _T  v = queue.topPriority();
         queue.pop();
 
-        double label = WSHED;
-        bool watershed = false;
+        int num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                 nb.border, p, neighbors);
+        int32_T label = L[p];
 
-        nhSetWalkerLocation(walker, p);
-        while (nhGetNextInboundsNeighbor(walker, &q, NULL))
+        if (lines)
         {
-            if ((L[q] != WSHED) && !watershed)
+            if (is_watershed(L, neighbors, num, label))
             {
-                if ((label != WSHED) && (L[q] != label))
+                if (contacts != NULL)
                 {
-                    watershed = true;
+                    add_watershed_contacts(L, neighbors, num, (double) v,
+                                           labels, contacts);
                 }
-                else
+                continue;
+            }
+            L[p] = label;
+        }
+        else if (F != NULL)
+        {
+            set_bit(F, p);
+            for (int k = 0; k < num; k++)
+            {
+                int q = neighbors[k];
+                if (test_bit(F, q) && (L[q] != label))
                 {
-                    label = L[q];
+                    add_contact(contacts, label, L[q], (double) v);
                 }
             }
         }
 
-        if (!watershed)
+        for (int k = 0; k < num; k++)
         {
-            L[p] = label;
-            nhSetWalkerLocation(walker, p);
-            while (nhGetNextInboundsNeighbor(walker, &q, NULL))
+            int q = neighbors[k];
+            if (!test_bit(S, q))
             {
-                if (!S[q])
+                set_bit(S, q);
+                if (!lines)
                 {
-                    S[q] = true;
-                    queue.push(q, std::max(I[q], v));
+                    L[q] = label;
                 }
+                queue.push(q, std::max(I[q], v));
             }
         }
     }
 
+    delete[] F;
+    delete[] labels;
+    delete[] neighbors;
     delete[] S;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// v + h, saturated and rounded as the integer image arithmetic does.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T>
+inline _T add_height(_T v, double h)
+{
+    double r = (double) v + h;
+    if (std::numeric_limits<_T>::is_integer)
+    {
+        r = std::floor(r + 0.5);
+        if (r > (double) std::numeric_limits<_T>::max())
+        {
+            return std::numeric_limits<_T>::max();
+        }
+    }
+    return (_T) r;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// The h-minima of I, as imextendedmin finds them: the regional minima of
+// I once every basin shallower than h has been filled.  The filling is a
+// reconstruction by erosion of I+h above I, flooded with the watershed
+// queue, lowest values first.  The minima are numbered 1, 2, ... in L in
+// the order of their first pixel, the other pixels getting 0.  Returns
+// the number of minima.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T, typename _Q>
+int32_T find_hminima(const _T *I, const int *size, int num_dims,
+                     Neighborhood_T nhood, double h, int32_T *L, _Q &queue)
+{
+    int N = 1;
+    for (int k = 0; k < num_dims; k++)
+    {
+        N *= size[k];
+    }
+
+    Neighbors nb;
+    make_neighbors(nhood, size, num_dims, nb);
+    int32_T *neighbors = new int32_T[nhGetNumNeighbors(nb.walker)];
+    _T *F = new _T[N];
+
+    for (int p = 0; p < N; p++)
+    {
+        F[p] = add_height(I[p], h);
+        queue.push(p, F[p]);
+    }
+
+    // A pixel lowered after it was pushed is popped again at its new
+    // value; the older entry is skipped.
+    while (! queue.isEmpty())
+    {
+        int p = queue.topData();
+        _T  v = queue.topPriority();
+        queue.pop();
+        if (v != F[p])
+        {
+            continue;
+        }
+
+        int num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                 nb.border, p, neighbors);
+        for (int k = 0; k < num; k++)
+        {
+            int q = neighbors[k];
+            _T w = std::max(v, I[q]);
+            if (w < F[q])
+            {
+                F[q] = w;
+                queue.push(q, w);
+            }
+        }
+    }
+
+    // Regional minima: plateaus of F with no lower neighbor.
+    uint32_T *visited = new_bits(N);
+    std::vector<int> plateau;
+    int32_T num_minima = 0;
+
+    for (int p = 0; p < N; p++)
+    {
+        L[p] = 0;
+    }
+    for (int p = 0; p < N; p++)
+    {
+        if (test_bit(visited, p))
+        {
+            continue;
+        }
+
+        bool minimum = true;
+        plateau.assign(1, p);
+        set_bit(visited, p);
+        for (size_t j = 0; j < plateau.size(); j++)
+        {
+            int num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                     nb.border, plateau[j], neighbors);
+            for (int k = 0; k < num; k++)
+            {
+                int q = neighbors[k];
+                if (F[q] < F[p])
+                {
+                    minimum = false;
+                }
+                else if ((F[q] == F[p]) && !test_bit(visited, q))
+                {
+                    set_bit(visited, q);
+                    plateau.push_back(q);
+                }
+            }
+        }
+
+        if (minimum)
+        {
+            num_minima++;
+            for (size_t j = 0; j < plateau.size(); j++)
+            {
+                L[plateau[j]] = num_minima;
+            }
+        }
+    }
+
+    delete[] visited;
+    delete[] F;
+    delete[] neighbors;
+    destroy_neighbors(nb);
+
+    return num_minima;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Euclidean distance in pixels between pixels p and q.
+//////////////////////////////////////////////////////////////////////////////
+inline double pixel_distance(int p, int q, const int *size, int num_dims)
+{
+    double d2 = 0.0;
+    for (int k = 0; k < num_dims; k++)
+    {
+        double d = (double) (p % size[k] - q % size[k]);
+        d2 += d * d;
+        p /= size[k];
+        q /= size[k];
+    }
+    return std::sqrt(d2);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Compact watershed: P. Neubert and P. Protzel, "Compact watershed and
+// preemptive SLIC," ICPR 2014.  A pixel is pushed with priority
+// I + compactness * (its distance to the marker pixel its pusher was
+// flooded from), and pushed again by any neighbor offering a lower one;
+// it is flooded, with the watershed rule above, at the lowest.  Each
+// flooded pixel keeps its marker pixel, so the penalty of a push costs
+// one distance.  L holds the markers on entry.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T>
+void compute_compact_watershed(_T *I, const int *size, int num_dims,
+                               Neighborhood_T nhood, int32_T *L,
+                               double compactness)
+{
+    int N = 1;
+    for (int k = 0; k < num_dims; k++)
+    {
+        N *= size[k];
+    }
+
+    Neighbors nb;
+    make_neighbors(nhood, size, num_dims, nb);
+    int32_T *neighbors = new int32_T[nhGetNumNeighbors(nb.walker)];
+    FifoPriorityQueue<int, double> queue(FifoPriorityItemCompareFcn<int, double>::LowestPriorityFirst);
+    double *cost = new double[N];
+    int32_T *seed = new int32_T[N];
+    uint32_T *done = new_bits(N);
+
+    const int32_T WSHED = 0;
+
+    for (int p = 0; p < N; p++)
+    {
+        cost[p] = mxGetInf();
+        seed[p] = p;
+        if (L[p] != WSHED)
+        {
+            set_bit(done, p);
+        }
+    }
+
+    for (int p = 0; p < N; p++)
+    {
+        int num = 0;
+        if (L[p] != WSHED)
+        {
+            num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                 nb.border, p, neighbors);
+        }
+        for (int k = 0; k < num; k++)
+        {
+            int q = neighbors[k];
+            double priority = (double) I[q] +
+                compactness * pixel_distance(q, p, size, num_dims);
+            if (!test_bit(done, q) && (priority < cost[q]))
+            {
+                cost[q] = priority;
+                seed[q] = p;
+                queue.push(q, priority);
+            }
+        }
+    }
+
+    while (! queue.isEmpty())
+    {
+        int p = queue.topData();
+        double v = queue.topPriority();
+        queue.pop();
+        if (test_bit(done, p) || (v != cost[p]))
+        {
+            continue;
+        }
+        set_bit(done, p);
+
+        int num = nhGetNeighbors(nb.walker, nb.offsets, nb.num_offsets,
+                                 nb.border, p, neighbors);
+        int32_T label;
+        if (is_watershed(L, neighbors, num, label))
+        {
+            continue;
+        }
+
+        L[p] = label;
+        for (int k = 0; k < num; k++)
+        {
+            int q = neighbors[k];
+            if (test_bit(done, q))
+            {
+                continue;
+            }
+            double priority = (double) I[q] +
+                compactness * pixel_distance(q, seed[p], size, num_dims);
+            if (priority < cost[q])
+            {
+                cost[q] = priority;
+                seed[q] = seed[p];
+                queue.push(q, priority);
+            }
+        }
+    }
+
+    delete[] done;
+    delete[] seed;
+    delete[] cost;
+    delete[] neighbors;
+    destroy_neighbors(nb);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// How to flood; see mexFunction for the arguments they come from.
+//////////////////////////////////////////////////////////////////////////////
+struct FloodOptions
+{
+    double  h;              // h-minima markers if >= 0
+    double  compactness;    // compact watershed if > 0
+    bool    lines;          // keep the watershed lines
+    std::vector<Contact> *contacts;  // collect the contacts if not NULL
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// With h >= 0 the markers are the h-minima of I; otherwise L holds them
+// on entry.  A positive compactness floods with compute_compact_watershed,
+// on the whole image.  Returns the number of h-minima.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T, typename _Q>
+int32_T compute_watershed(_T *I, const int *size, int num_dims,
+                          Neighborhood_T nhood, int32_T *L, _Q &queue,
+                          const FloodOptions &opts)
+{
+    int32_T num_minima = 0;
+    if (opts.h >= 0.0)
+    {
+        num_minima = find_hminima(I, size, num_dims, nhood, opts.h, L, queue);
+    }
+
+    if (opts.compactness > 0.0)
+    {
+        compute_compact_watershed(I, size, num_dims, nhood, L,
+                                  opts.compactness);
+        return num_minima;
+    }
+
+    int N = 1;
+    for (int k = 0; k < num_dims; k++)
+    {
+        N *= size[k];
+    }
+
+    Neighbors nb;
+    make_neighbors(nhood, size, num_dims, nb);
+    compute_watershed(I, N, nb, L, queue, opts.lines, opts.contacts);
+    destroy_neighbors(nb);
+
+    return num_minima;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Any input class: a heap ordered by priority, then by push order.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T>
+int32_T compute_watershed(_T *I, const int *size, int num_dims,
+                          Neighborhood_T nhood, int32_T *L,
+                          const FloodOptions &opts)
+{
+    FifoPriorityQueue<int, _T> queue(FifoPriorityItemCompareFcn<int, _T>::LowestPriorityFirst);
+    return compute_watershed(I, size, num_dims, nhood, L, queue, opts);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Logical, uint8 and uint16 inputs: one FIFO per gray level.  The order
+// in which pixels are flooded, and so the result, is the same.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _T>
+int32_T compute_watershed_buckets(_T *I, const int *size, int num_dims,
+                                  Neighborhood_T nhood, int32_T *L,
+                                  const FloodOptions &opts, int num_levels)
+{
+    BucketPriorityQueue<int, _T> queue(num_levels);
+    return compute_watershed(I, size, num_dims, nhood, L, queue, opts);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Numbers the distinct nonzero marker values 1, 2, ... in increasing
+// order.  L gets the numbers and values[n] the value numbered n, values[0]
+// being the watershed label 0.  Only the distinct values are kept, in a
+// set; runs of one value are inserted once.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _M>
+void number_markers(const _M *M, int N, int32_T *L,
+                    std::vector<double> &values)
+{
+    std::set<_M> distinct;
+    for (int p = 0; p < N; p++)
+    {
+        if ((M[p] != 0) && ((p == 0) || (M[p] != M[p - 1])))
+        {
+            distinct.insert(M[p]);
+        }
+    }
+    values.assign(1, 0.0);
+    values.insert(values.end(), distinct.begin(), distinct.end());
+
+    for (int p = 0; p < N; p++)
+    {
+        L[p] = 0;
+        if (M[p] != 0)
+        {
+            L[p] = (int32_T) (std::lower_bound(values.begin() + 1, values.end(),
+                                               (double) M[p]) - values.begin());
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// uint8 and uint16 markers: the numbers are looked up in a table with
+// one entry per value.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _M>
+void number_markers_table(const _M *M, int N, int32_T *L,
+                          std::vector<double> &values, int num_levels)
+{
+    std::vector<int32_T> number(num_levels, 0);
+    for (int p = 0; p < N; p++)
+    {
+        number[M[p]] = 1;
+    }
+
+    values.assign(1, 0.0);
+    for (int v = 1; v < num_levels; v++)
+    {
+        if (number[v] != 0)
+        {
+            number[v] = (int32_T) values.size();
+            values.push_back((double) v);
+        }
+    }
+    number[0] = 0;
+
+    for (int p = 0; p < N; p++)
+    {
+        L[p] = number[M[p]];
+    }
+}
+
+void number_markers(const mxArray *M, int N, int32_T *L,
+                    std::vector<double> &values)
+{
+    switch (mxGetClassID(M))
+    {
+    case mxDOUBLE_CLASS:
+        number_markers((double *) mxGetData(M), N, L, values);
+        break;
+
+    case mxINT32_CLASS:
+        number_markers((int32_T *) mxGetData(M), N, L, values);
+        break;
+
+    case mxUINT16_CLASS:
+        number_markers_table((uint16_T *) mxGetData(M), N, L, values, 65536);
+        break;
+
+    case mxUINT8_CLASS:
+        number_markers_table((uint8_T *) mxGetData(M), N, L, values, 256);
+        break;
+
+    default:
+        mxAssert(false, "Unexpected mxClassID in switch statement");
+        break;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Replaces the marker numbers by their values; out may be L itself.
+//////////////////////////////////////////////////////////////////////////////
+template<typename _L>
+void write_labels(const int32_T *L, int N, const std::vector<double> &values,
+                  _L *out)
+{
+    for (int p = 0; p < N; p++)
+    {
+        out[p] = (_L) values[L[p]];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// The region adjacency graph: one row [a b length min mean] per pair of
+// adjacent basins, a < b being their label values, sorted.  length is the
+// number of contacts between the two basins, min and mean are taken over
+// their flooding levels.
+//////////////////////////////////////////////////////////////////////////////
+mxArray *make_adjacency_graph(std::vector<Contact> &contacts,
+                              const std::vector<double> &values)
+{
+    std::sort(contacts.begin(), contacts.end());
+
+    int num_edges = 0;
+    for (size_t j = 0; j < contacts.size(); j++)
+    {
+        if ((j == 0) || (contacts[j - 1] < contacts[j]))
+        {
+            num_edges++;
+        }
+    }
+
+    mxArray *rag = mxCreateDoubleMatrix(num_edges, 5, mxREAL);
+    double *R = mxGetPr(rag);
+    int e = -1;
+    for (size_t j = 0; j < contacts.size(); j++)
+    {
+        const Contact &c = contacts[j];
+        if ((j == 0) || (contacts[j - 1] < c))
+        {
+            e++;
+            R[e] = values[c.a];
+            R[e + num_edges] = values[c.b];
+            R[e + 2 * num_edges] = 0.0;
+            R[e + 3 * num_edges] = c.v;
+            R[e + 4 * num_edges] = 0.0;
+        }
+        R[e + 2 * num_edges] += 1.0;
+        R[e + 3 * num_edges] = std::min(R[e + 3 * num_edges], c.v);
+        R[e + 4 * num_edges] += c.v;
+    }
+    for (e = 0; e < num_edges; e++)
+    {
+        R[e + 4 * num_edges] /= R[e + 2 * num_edges];
+    }
+
+    return rag;
+}
+
+bool labels_fit(const std::vector<double> &values, double lo, double hi)
+{
+    for (size_t n = 0; n < values.size(); n++)
+    {
+        if ((values[n] < lo) || (values[n] > hi) ||
+            (values[n] != std::floor(values[n])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// A scalar M for a larger I is the height h of the h-minima to use as
+// markers.
+//////////////////////////////////////////////////////////////////////////////
+bool is_height(const mxArray *I, const mxArray *M)
+{
+    return (mxGetNumberOfElements(M) == 1) && (mxGetNumberOfElements(I) > 1);
+}
+
 #define SIZE_MISMATCH_ID  "Images:watershed_meyer:sizeMismatch"
 #define SIZE_MISMATCH_MSG "I must be the same size as L."
 
@@ -117,18 +801,72 @@ void check_inputs(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
     int num_dims;
 
-    if (nrhs != 3)
+    if ((nrhs < 3) || (nrhs > 6))
     {
         mexErrMsgIdAndTxt("Images:watershed_meyer:invalidNumInputs",
                           "%s",
-                          "WATERSHED_MEYER needs 3 input arguments.");
+                          "WATERSHED_MEYER needs 3 to 6 input arguments.");
+    }
+
+    if (nlhs > 2)
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidNumOutputs",
+                          "%s",
+                          "WATERSHED_MEYER returns at most two outputs.");
+    }
+
+    if ((nrhs >= 4) && !mxIsChar(prhs[3]))
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidOutputClass",
+                          "%s",
+                          "Fourth input argument to WATERSHED_MEYER must be 'double', 'int32' or 'uint16'.");
+    }
+
+    // COMPACTNESS and LINES are checked before mxGetScalar reads them.
+    if ((nrhs >= 5) && (!mxIsNumeric(prhs[4]) || mxIsComplex(prhs[4]) ||
+                        (mxGetNumberOfElements(prhs[4]) != 1) ||
+                        !(mxGetScalar(prhs[4]) >= 0.0) ||
+                        !mxIsFinite(mxGetScalar(prhs[4]))))
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidCompactness",
+                          "%s",
+                          "Fifth input argument to WATERSHED_MEYER must be a finite nonnegative scalar.");
     }
 
-    if (!mxIsDouble(prhs[2]))
+    if ((nrhs >= 6) && ((!mxIsNumeric(prhs[5]) && !mxIsLogical(prhs[5])) ||
+                        (mxGetNumberOfElements(prhs[5]) != 1)))
     {
-        mexErrMsgIdAndTxt("Images:watershed_meyer:nondoubleMinimaLabels",
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidLines",
                           "%s",
-                          "Third input argument to WATERSHED_MEYER must be double.");
+                          "Sixth input argument to WATERSHED_MEYER must be a logical scalar.");
+    }
+
+    if ((nrhs >= 5) && (mxGetScalar(prhs[4]) > 0.0) &&
+        ((nlhs > 1) || ((nrhs == 6) && (mxGetScalar(prhs[5]) == 0.0))))
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidCompactOptions",
+                          "%s",
+                          "A compact watershed has no line-free mode or adjacency graph.");
+    }
+
+    mxClassID class_M = mxGetClassID(prhs[2]);
+    if ((class_M != mxDOUBLE_CLASS) && (class_M != mxINT32_CLASS) &&
+        (class_M != mxUINT16_CLASS) && (class_M != mxUINT8_CLASS))
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:invalidMinimaLabels",
+                          "%s",
+                          "Third input argument to WATERSHED_MEYER must be double, int32, uint16 or uint8.");
+    }
+
+    if (is_height(prhs[0], prhs[2]))
+    {
+        if (!(mxGetScalar(prhs[2]) >= 0.0))
+        {
+            mexErrMsgIdAndTxt("Images:watershed_meyer:invalidHeight",
+                              "%s",
+                              "The h-minima height given to WATERSHED_MEYER must be nonnegative.");
+        }
+        return;
     }
 
     num_dims = mxGetNumberOfDimensions(prhs[0]);
@@ -146,22 +884,51 @@ void check_inputs(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
             mexErrMsgIdAndTxt(SIZE_MISMATCH_ID, "%s", SIZE_MISMATCH_MSG);
         }
     }
+
+    // number_markers orders the marker values, which NaN would break.
+    if (class_M == mxDOUBLE_CLASS)
+    {
+        const double *M = (const double *) mxGetData(prhs[2]);
+        int N = mxGetNumberOfElements(prhs[2]);
+        for (int p = 0; p < N; p++)
+        {
+            if (!mxIsFinite(M[p]))
+            {
+                mexErrMsgIdAndTxt("Images:watershed_meyer:invalidMinimaLabels",
+                                  "%s",
+                                  "Third input argument to WATERSHED_MEYER must not contain NaN or Inf.");
+            }
+        }
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////
-//
+// [L, RAG] = WATERSHED_MEYER(I, CONN, M, CLASS, COMPACTNESS, LINES)
+// M holds the finite marker labels (double, int32, uint16 or uint8), or
+// is a scalar h to flood from the h-minima of I, numbered 1, 2, ...
+// CLASS is the class of L: 'double' (default), 'int32' or 'uint16'.  A
+// positive COMPACTNESS (default 0) floods a compact watershed.  With
+// LINES false (default true) every pixel reached joins a basin and there
+// are no watershed lines.  RAG is the region adjacency graph made by
+// make_adjacency_graph: a contact is a watershed pixel or, without
+// lines, a pair of neighbors in two basins, at the level where the
+// fronts met.
 //////////////////////////////////////////////////////////////////////////////
 extern "C"
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
     void *I;
-    double *L;
+    int32_T *L;
     int num_elements;
     const int *input_size;
     int ndims;
     mxClassID class_id;
+    mxClassID out_class = mxDOUBLE_CLASS;
     Neighborhood_T nhood;
-    NeighborhoodWalker_T walker;
+    FloodOptions opts;
+    int32_T num_minima = 0;
+    std::vector<double> values;
+    std::vector<Contact> contacts;
 
     check_inputs(nlhs, plhs, nrhs, prhs);
 
@@ -178,59 +945,119 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     input_size = mxGetDimensions(prhs[0]);
     ndims = mxGetNumberOfDimensions(prhs[0]);
     
-    plhs[0] = mxCreateNumericArray(ndims, input_size, mxDOUBLE_CLASS, mxREAL);
-    L = mxGetPr(plhs[0]);
+    opts.h = -1.0;
+    opts.compactness = 0.0;
+    opts.lines = true;
+    opts.contacts = (nlhs > 1) ? &contacts : NULL;
+
+    if (nrhs > 4)
+    {
+        opts.compactness = mxGetScalar(prhs[4]);
+    }
+
+    if (nrhs > 5)
+    {
+        opts.lines = (mxGetScalar(prhs[5]) != 0.0);
+    }
+
+    if (nrhs > 3)
+    {
+        char *name = mxArrayToString(prhs[3]);
+        if (strcmp(name, "int32") == 0)
+        {
+            out_class = mxINT32_CLASS;
+        }
+        else if (strcmp(name, "uint16") == 0)
+        {
+            out_class = mxUINT16_CLASS;
+        }
+        else if (strcmp(name, "double") != 0)
+        {
+            mexErrMsgIdAndTxt("Images:watershed_meyer:invalidOutputClass",
+                              "%s",
+                              "Fourth input argument to WATERSHED_MEYER must be 'double', 'int32' or 'uint16'.");
+        }
+        mxFree(name);
+    }
+
+    // The basins are flooded with the markers numbered 1, 2, ... in an
+    // int32 image, which is the output itself for int32 labels.
+    plhs[0] = mxCreateNumericArray(ndims, input_size, out_class, mxREAL);
+    if (out_class == mxINT32_CLASS)
+    {
+        L = (int32_T *) mxGetData(plhs[0]);
+    }
+    else
+    {
+        L = (int32_T *) mxMalloc(num_elements * sizeof(int32_T));
+    }
+    if (is_height(prhs[0], prhs[2]))
+    {
+        opts.h = mxGetScalar(prhs[2]);
+    }
+    else
+    {
+        number_markers(prhs[2], num_elements, L, values);
+    }
+
+    if (((out_class == mxINT32_CLASS) &&
+         !labels_fit(values, -2147483648.0, 2147483647.0)) ||
+        ((out_class == mxUINT16_CLASS) && !labels_fit(values, 0.0, 65535.0)))
+    {
+        mexErrMsgIdAndTxt("Images:watershed_meyer:labelsOutOfRange",
+                          "%s",
+                          "The labels in the third input argument to WATERSHED_MEYER do not fit the output class.");
+    }
 
     nhood = nhMakeNeighborhood(prhs[1],NH_CENTER_MIDDLE_ROUNDDOWN);
-    walker = nhMakeNeighborhoodWalker(nhood,input_size,ndims,NH_SKIP_CENTER);
     
     switch (class_id)
     {
     case mxLOGICAL_CLASS:
-        compute_watershed((mxLogical *)I, (double *) mxGetData(prhs[2]),  num_elements,
-                          walker, L);
+        num_minima = compute_watershed_buckets((mxLogical *)I, input_size, ndims,
+                                               nhood, L, opts, 2);
         break;
         
     case mxUINT8_CLASS:
-        compute_watershed((uint8_T *)I, (double *) mxGetData(prhs[2]), num_elements, walker, 
-                          L);
+        num_minima = compute_watershed_buckets((uint8_T *)I, input_size, ndims,
+                                               nhood, L, opts, 256);
         break;
         
     case mxUINT16_CLASS:
-        compute_watershed((uint16_T *)I, (double *) mxGetData(prhs[2]), num_elements, 
-                          walker, L);
+        num_minima = compute_watershed_buckets((uint16_T *)I, input_size, ndims,
+                                               nhood, L, opts, 65536);
         break;
 
     case mxUINT32_CLASS:
-        compute_watershed((uint32_T *)I, (double *) mxGetData(prhs[2]), num_elements,
-                          walker, L);
+        num_minima = compute_watershed((uint32_T *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     case mxINT8_CLASS:
-        compute_watershed((int8_T *)I, (double *) mxGetData(prhs[2]), num_elements, 
-                          walker, L);
+        num_minima = compute_watershed((int8_T *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     case mxINT16_CLASS:
-        compute_watershed((int16_T *)I, (double *) mxGetData(prhs[2]), num_elements,
-                          walker, L);
+        num_minima = compute_watershed((int16_T *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     case mxINT32_CLASS:
-        compute_watershed((int32_T *)I, (double *) mxGetData(prhs[2]), num_elements,
-                          walker, L);
+        num_minima = compute_watershed((int32_T *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     case mxSINGLE_CLASS:
         do_nan_check((float *)I, num_elements);
-        compute_watershed((float *)I, (double *) mxGetData(prhs[2]), num_elements, 
-                          walker, L);
+        num_minima = compute_watershed((float *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     case mxDOUBLE_CLASS:
         do_nan_check((double *)I, num_elements);
-        compute_watershed((double *)I, (double *) mxGetData(prhs[2]), num_elements,
-                          walker, L);
+        num_minima = compute_watershed((double *)I, input_size, ndims, nhood, L,
+                                       opts);
         break;
 
     default:
@@ -239,5 +1066,41 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     }
 
     nhDestroyNeighborhood(nhood);
-    nhDestroyNeighborhoodWalker(walker);
+
+    if (opts.h >= 0.0)
+    {
+        values.resize(num_minima + 1);
+        for (int32_T n = 0; n <= num_minima; n++)
+        {
+            values[n] = n;
+        }
+        if ((out_class == mxUINT16_CLASS) && !labels_fit(values, 0.0, 65535.0))
+        {
+            mexErrMsgIdAndTxt("Images:watershed_meyer:labelsOutOfRange",
+                              "%s",
+                              "The h-minima of the first input argument to WATERSHED_MEYER are too many for uint16 labels.");
+        }
+    }
+
+    if (nlhs > 1)
+    {
+        plhs[1] = make_adjacency_graph(contacts, values);
+    }
+
+    switch (out_class)
+    {
+    case mxINT32_CLASS:
+        write_labels(L, num_elements, values, L);
+        break;
+
+    case mxUINT16_CLASS:
+        write_labels(L, num_elements, values, (uint16_T *) mxGetData(plhs[0]));
+        mxFree(L);
+        break;
+
+    default:
+        write_labels(L, num_elements, values, mxGetPr(plhs[0]));
+        mxFree(L);
+        break;
+    }
 }
@@ -76,6 +76,7 @@ case 1
     addpath([cvsroot '/segment/matlab/mex'])
     addpath([cvsroot '/3D/matlab/mex'])
     addpath([cvsroot '/input/matlab/mex'])
+    addpath([cvsroot '/preprocess/matlab/mex'])
     
 case 2
     addpath([cvsroot '/3D/matlab']);
@@ -93,6 +94,7 @@ case 2
     addpath([cvsroot '/input/matlab/mex']);
     addpath([cvsroot '/misc']);
     addpath([cvsroot '/preprocess/matlab']);
+    addpath([cvsroot '/preprocess/matlab/mex']);
     addpath([cvsroot '/SDA/matlab']);
     addpath([cvsroot '/segment/matlab']);
     addpath([cvsroot '/SImEC/matlab']);
@@ -52,6 +52,7 @@ end
 %    addpath([cvsroot '/input/matlab/mex']);
 %    addpath([cvsroot '/misc']);
     addpath([cvsroot '/preprocess/matlab']);
+    addpath([cvsroot '/preprocess/matlab/mex']);
 %    addpath([cvsroot '/SDA/matlab']);
 %    addpath([cvsroot '/segment/matlab']);
 %    addpath([cvsroot '/SImEC/matlab']);